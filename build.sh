@@ -10,4 +10,4 @@ make -j4
 echo "Done! Run with:"
 echo "  ./ant_mania ../task/hiveum_map_small.txt 100"
 echo "  ./ant_mania ../task/hiveum_map_medium.txt 1000"
-echo "  ./benchmark ./ant_mania"
\ No newline at end of file
+echo "  ./benchmark [--format json|csv] [map_file ant_counts...]"
\ No newline at end of file
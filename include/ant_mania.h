@@ -3,6 +3,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <random>
@@ -11,49 +12,148 @@
 #include <cassert>
 #include <sstream>
 #include <array>
+#include <memory>
+
+#include "fast_rng.h"
+#include "instrumentation.h"
+#include "checkpoint.h"
+#include "colony_graph.h"
+#include "huge_page_arena.h"
+#include "move_kernel.h"
+#include "output_sink.h"
+#include "simulation_observer.h"
+#include "simulation_policy.h"
+#include "thread_pool.h"
 
 // Ant Mania Simulation - High Performance Implementation
 // Key features:
-// 1. Three-pass map parsing to resolve colony IDs correctly
+// 1. Single-pass zero-copy map parsing over an mmap'd file
 // 2. Proper collision reporting with ant IDs
-// 3. Efficient data structures (fixed-size arrays)
-// 4. Efficient random number generation
+// 3. Efficient data structures (fixed-size arrays, SoA ant storage with dead-ant compaction)
+// 4. Efficient random number generation (xoshiro256** batches, reproducible seeding)
 // 5. Incremental termination checking
 // 6. Correct fight counting
 // 7. Zero allocations in hot path (checkCollisions)
 // 8. Constexpr direction helpers with enum class
+// 9. Sparse collision detection proportional to live ants, not colonies
+// 10. Optional fused move-and-collide engine (single pass over ants)
+// 11. Live-neighbor masks maintained incrementally through a reverse-adjacency index
+// 12. Optional multithreaded engine, deterministic regardless of thread count
+// 13. Ants alone in their connected component are fast-forwarded to their final state
+// 14. Buffered (optionally asynchronous) output with no flushes in the hot loop
+// 15. Compile-time optional per-iteration instrumentation (ANT_MANIA_INSTRUMENT)
+// 16. Precompiled binary maps, mmap'ed and used without parsing
+// 17. Shared immutable ColonyGraph with cheap per-run reset, for ensembles of trials
+// 18. Optional BFS / RCM renumbering of colonies for locality, invisible in the output
+// 19. 16-bit connection IDs for maps under 65535 colonies, destroyed flags in a bitmap
+// 20. Flat open-addressing name index; optional multithreaded parsing of large text maps
+// 21. AVX2 move kernel (eight ants per step), chosen at runtime, identical to the scalar path
+// 22. Bit-exact checkpoints of the mutable state, written by a background thread
+// 23. Observer template on the run loop; a no-op observer compiles away entirely
+// 24. Policy-specialized iteration path, chosen once per run from the map and flags
+// 25. Working set drawn from huge-page arenas (transparent or explicit), optionally prefaulted
+// 26. Resumable runs: step(n) / runFor(budget) slices with the same per-iteration loop as run()
+
+// Outcome of one ant's move, before any counters are updated
+enum class MoveResult : uint8_t {
+    MOVED,
+    REACHED_MAX,   // Moved, and this was move number MAX_MOVES
+    TRAPPED        // No live neighbour (or colony destroyed); the ant dies
+};
+
+// Structure-of-arrays ant storage: the move loop streams only the arrays it needs.
+// Killed ants are marked in place (colony DEAD_ANT) and squeezed out by compact()
+// once they make up enough of the store; ant_ids keeps the original ID for reporting.
+struct AntStore {
+    static constexpr uint32_t DEAD_ANT = UINT32_MAX;
+    
+    ArenaVector<uint32_t> colony_ids;   // Current colony (integer ID), DEAD_ANT once killed
+    ArenaVector<uint16_t> move_counts;  // Number of moves made
+    ArenaVector<uint32_t> ant_ids;      // Unique ant identifier for reporting
+    uint32_t dead_count = 0;            // Killed ants not yet compacted away
+    
+    explicit AntStore(HugePageArena* arena = nullptr)
+        : colony_ids(ArenaAllocator<uint32_t>(arena))
+        , move_counts(ArenaAllocator<uint16_t>(arena))
+        , ant_ids(ArenaAllocator<uint32_t>(arena)) {}
+    
+    size_t growthBytes(size_t n) const {  // Arena space reserve(n) still needs
+        return arenaGrowth(colony_ids, n) + arenaGrowth(move_counts, n) + arenaGrowth(ant_ids, n);
+    }
+    size_t size() const { return colony_ids.size(); }
+    bool alive(size_t i) const { return colony_ids[i] != DEAD_ANT; }
+    
+    void clear();
+    void reserve(size_t n);
+    void add(uint32_t colony_id, uint32_t ant_id);
+    void kill(size_t i) { colony_ids[i] = DEAD_ANT; dead_count++; }
+    void retire(size_t i) { kill(i); }  // Finished ant that is still alive; counters track it
+    void compact();
+};
 
-enum class Direction : uint8_t {
-    NORTH = 0,
-    SOUTH = 1,
-    EAST = 2,
-    WEST = 3,
-    INVALID = 255
+// Where a run stands between step() calls
+enum class RunState : uint8_t {
+    IDLE = 0,      // Ants created (or a checkpoint restored); the next step starts the run
+    RUNNING = 1,   // Started and not yet terminated
+    FINISHED = 2   // Every ant dead or at MAX_MOVES; runEnd has been reported
 };
 
-struct Ant {
-    uint32_t colony_id;    // Current colony (integer ID)
-    uint16_t move_count;   // Number of moves made
-    bool alive;            // Is ant still alive
-    uint32_t ant_id;       // Unique ant identifier for reporting
+// Progress after a step() or runFor() call
+struct StepResult {
+    uint32_t steps;               // Iterations advanced by this call
+    uint32_t iterations;          // Iterations so far, as getIterations()
+    uint32_t ants_alive;
+    uint32_t colonies_destroyed;
+    bool finished;                // The run terminated (in this call or before it)
+};
+
+// Per-iteration occupancy of one colony. Only meaningful when stamp equals the
+// simulation's current occupancy generation, so nothing needs clearing between iterations.
+struct ColonyOccupancy {
+    uint32_t stamp;                   // Generation that last touched this slot
+    uint32_t count;                   // Ants in the colony this iteration
+    uint32_t head;                    // First ant index in the occupant list (see next_occupant)
+    std::array<uint32_t, 2> ant_ids;  // First 2 ant IDs for reporting
+};
+
+// Ant index plus its destination, bucketed by collision partition in the parallel engine
+struct OccupantClaim {
+    uint32_t colony_id;
+    uint32_t ant_index;
 };
 
-struct Colony {
-    std::array<uint32_t, 4> connections;  // north, south, east, west -> colony IDs (UINT32_MAX = no connection)
-    bool destroyed;                        // Is colony destroyed
+// Per-worker scratch for the parallel engine. Worker w fills buckets[p] while moving
+// its ant range; collision partition p then drains buckets[0..W)[p] in worker order.
+struct alignas(64) WorkerScratch {
+    std::vector<std::vector<OccupantClaim>> buckets;  // One per collision partition
+    std::vector<uint32_t> touched;                    // Colonies claimed by this partition
+    std::vector<uint32_t> destroyed;                  // Partition's colonies with 2+ ants
+    uint32_t trapped = 0;                             // Ants that died in the move phase
+    uint32_t trapped_at_max = 0;                      // ...of which had already reached MAX_MOVES
+    uint32_t reached_max = 0;                         // Ants whose move hit MAX_MOVES
+    uint32_t moved = 0;                               // Successful moves this iteration
+    std::vector<TrappedAnt> trapped_ants;             // Only filled while recording trapped ants
 };
 
 class AntManiaSimulation {
 private:
+    // Backs the per-colony and per-ant arrays below; declared first so it outlives them.
+    // The map's tables live in the graph's own arena (it may be shared across runs).
+    HugePageArena memory;
+    
     // Core data structures - optimized for cache performance
-    std::vector<Ant> ants;
-    std::vector<Colony> colonies;
+    AntStore ants;
     
-    // Lookup tables for string <-> ID conversion
-    std::vector<std::string> colony_names;
-    std::unordered_map<std::string, uint32_t> name_to_id;
+    // Shared read-only map plus this run's colony state: live masks and a destroyed bitmap
+    std::shared_ptr<const ColonyGraph> graph;
+    ArenaVector<uint8_t> live_masks;       // Bit d set if tunnel d leads to a live colony; zero-padded to a multiple of 4
+    ArenaVector<uint64_t> destroyed_bits;  // Bit c set once colony c is destroyed
     
-    // Random number generation - multiple distributions for unbiased selection
+    // Random number generation - one seed drives whichever generator is selected
+    RngKind rng_kind;
+    uint64_t seed;
+    Xoshiro256 fast_rng;
+    ArenaVector<uint32_t> random_batch;  // One raw draw per ant slot, refilled each iteration
     std::mt19937_64 rng;
     std::uniform_int_distribution<uint32_t> direction_dist;
     std::array<std::uniform_int_distribution<uint8_t>, 4> count_dists;  // For unbiased random selection
@@ -62,31 +162,269 @@ private:
     uint32_t total_ants;
     uint32_t colonies_destroyed;
     uint32_t total_fight_pairs;  // Total number of ant pairs that fought
+    uint32_t iterations;         // Iterations of the current or last run; the current one during an iteration
+    uint64_t total_ant_steps;    // Moves made by all ants, including fast-forwarded ones
     
     // Incremental counters for efficient termination checking
     uint32_t alive_ants_count;
     uint32_t max_moves_ants_count;
     
-    // Reusable buffers to avoid allocations in hot path
-    std::vector<uint32_t> colony_ant_counts;
-    std::vector<std::array<uint32_t, 2>> colony_ant_ids;  // Store first 2 IDs per colony
+    // Sparse collision tracking - only colonies occupied this iteration are touched
+    ArenaVector<ColonyOccupancy> occupancy;       // Indexed by colony ID
+    ArenaVector<uint32_t> next_occupant;          // Indexed by ant index, links the occupant lists
+    std::vector<uint32_t> touched_colonies;       // Colonies claimed this iteration
+    std::vector<uint32_t> destroyed_this_iteration;
+    uint32_t occupancy_generation;
+    
+    // Ants trapped this iteration, recorded only when the observer listens for them
+    bool record_trapped;
+    std::vector<TrappedAnt> trapped_this_iteration;
+    
+    // A run may be spread over many step() calls; only time inside them is counted
+    RunState run_state;
+    std::chrono::high_resolution_clock::time_point slice_start;
+    std::chrono::high_resolution_clock::duration run_time;  // Completed slices of this run
+    
+    // Settings the current run started with; the setters only take effect at the next run
+    SimulationEngine run_engine;
+    RngKind run_rng;
+    uint32_t run_threads;
+    
+    SimulationEngine engine;
+    
+    // Parallel engine state
+    uint32_t num_threads;
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<WorkerScratch> scratch;  // One per worker
+    
+    // Fast-forward of ants alone in their connected component
+    bool fast_forward;
+    uint32_t fast_forward_interval;      // Iterations between component checks
+    uint32_t fast_forward_countdown;
+    uint32_t last_check_destroyed;       // colonies_destroyed at the last component rebuild
+    uint32_t last_check_alive;           // alive_ants_count at the last component rebuild
+    ArenaVector<uint32_t> component_of;  // Component label per live colony
+    std::vector<uint32_t> component_ants;
+    std::vector<uint8_t> component_trap_free;  // Every colony in it has a live neighbour
+    ArenaVector<uint32_t> bfs_queue;
+    
+    // Destruction messages, progress lines and the final map go through one buffered sink
+    OutputSink output;
+    bool silent;  // Suppresses every console line, not just destruction messages
+    ColonyOrder colony_order;  // Applied by loadMap()
+    uint32_t loader_threads;   // Threads for parsing text maps in loadMap()
+    bool vector_moves;         // AVX2 move kernel; only set if the CPU supports it
+    bool specialized;          // Use a specialized policy when one matches the configuration
+    
+    // One iteration, instantiated for a policy; picked by selectAdvance() at the start of a run
+    using AdvanceFn = bool (AntManiaSimulation::*)();
+    AdvanceFn advance_step;
+    
+    // Checkpoints every checkpoint_interval iterations (0 = never), written in the background
+    std::string checkpoint_path;
+    uint32_t checkpoint_interval;
+    SimulationSnapshot checkpoint_buffer;  // Swapped with the writer's, so refills reuse storage
+    std::unique_ptr<CheckpointWriter> checkpoint_writer;
+    bool resume_pending;  // restoreCheckpoint() ran; the next runSimulation() continues from it
+    
+#ifdef ANT_MANIA_INSTRUMENT
+    Instrumentation instrumentation;
+#endif
     
     // Constants
     static constexpr uint32_t MAX_MOVES = 10000;
+    static constexpr double COMPACTION_DEAD_FRACTION = 0.5;  // Compact once half the store is dead
     static constexpr uint32_t NO_CONNECTION = UINT32_MAX;
+    static constexpr uint32_t NO_ANT = UINT32_MAX;
+    static constexpr uint32_t MIN_ANTS_PER_WORKER = 16384;  // Below this, fan-out costs more than it saves
+    static constexpr uint32_t FAST_FORWARD_MIN_INTERVAL = 64;
+    static constexpr uint32_t FAST_FORWARD_MAX_INTERVAL = 1024;
+    static constexpr uint32_t NO_COMPONENT = UINT32_MAX;
 
     // Helper functions
-    static Direction direction_to_enum(const std::string& direction);
-    static constexpr const char* enum_to_direction(Direction dir);
-    void moveAnts();
+    std::string_view colonyName(uint32_t colony_id) const { return graph->name(colony_id); }
+    uint32_t colonyCount() const { return graph ? graph->size() : 0; }
+    bool destroyed(uint32_t colony_id) const { return (destroyed_bits[colony_id >> 6] >> (colony_id & 63)) & 1; }
+    void destroyColony(uint32_t colony_id);
+    void clearLiveMasks(uint32_t colony_id);
+    void reserveAntMemory(size_t ant_count);
+    void sizeIterationBuffers();
+    AdvanceFn selectAdvance() const;
+    bool advanceGeneric();
+    template <SimulationEngine ENGINE, typename ColonyId> bool advanceGenericFor();
+    template <typename Policy> bool advanceWith();
+    template <typename Policy> void runIteration();
+    template <RngKind KIND, typename ColonyId> MoveResult stepAnt(uint32_t ant_index);
+    template <typename Policy> bool moveAnt(uint32_t ant_index);
+    void killAnt(uint32_t ant_index);
+    void recordTrapped(uint32_t ant_index);
+    template <typename Policy> bool useVectorMoves() const;
+    template <typename Policy> uint32_t moveVectorized(uint32_t begin, uint32_t end);
+    template <typename Policy> void moveAnts();
     void checkCollisions();
+    template <typename Policy> void moveAndCollide();
+    void beginOccupancy();
+    void claimOccupancy(uint32_t ant_index, uint32_t colony_id, std::vector<uint32_t>& touched);
+    void resolveCollisions();
+    void applyDestructions();
+    template <typename Policy> void runParallelIteration();
+    template <typename Policy> void parallelMove(uint32_t worker, uint32_t workers);
+    void parallelClaim(uint32_t partition, uint32_t workers);
+    void checkIsolatedAnts();
+    uint32_t labelComponents();
+    template <RngKind KIND, typename ColonyId> uint32_t fastForwardIsolatedAnts();
+    void captureSnapshot(SimulationSnapshot& snapshot, uint32_t completed_iterations) const;
+    bool applySnapshot(const SimulationSnapshot& snapshot, std::string& error);
+    void takeCheckpoint(uint32_t completed_iterations);
+    
+    // The run loop around the observer. Each step() is beginSlice() (which calls beginRun()
+    // for a new run), then advance_step and endIteration() per iteration, then endSlice(),
+    // or finishRun() once advance_step reports termination.
+    void beginRun(bool trapped_events);
+    void beginSlice(bool trapped_events);
+    void endIteration();
+    StepResult endSlice(uint32_t steps);
+    RunEndEvent finishRun();
+    void announceRun() const;  // "Starting simulation..." before a console run's first step
 
 public:
     AntManiaSimulation();
     
-    bool loadMap(const std::string& filename);
+    void setEngine(SimulationEngine new_engine) { engine = new_engine; }
+    void setRng(RngKind kind) { rng_kind = kind; }
+    void setThreads(uint32_t threads) { num_threads = threads > 0 ? threads : 1; }
+    void setFastForward(bool enabled) { fast_forward = enabled; }
+    void setColonyOrder(ColonyOrder order) { colony_order = order; }
+    void setLoaderThreads(uint32_t threads) { loader_threads = threads > 0 ? threads : 1; }
+    void setVectorMoves(bool enabled) { vector_moves = enabled && moveKernelAvailable(); }
+    void setSpecialized(bool enabled) { specialized = enabled; }  // false: always the generic path
+    void setMemoryOptions(const MemoryOptions& options) { memory.setOptions(options); }  // Before loadMap()
+    SimulationEngine getEngine() const { return engine; }
+    RngKind getRng() const { return rng_kind; }
+    uint32_t getThreads() const { return num_threads; }
+    bool getFastForward() const { return fast_forward; }
+    ColonyOrder getColonyOrder() const { return colony_order; }
+    bool getVectorMoves() const { return vector_moves; }
+    bool getSpecialized() const { return specialized; }
+    const MemoryOptions& getMemoryOptions() const { return memory.getOptions(); }
+    const HugePageArena& getMemory() const { return memory; }  // Run state; the map's is getGraph()->getMemory()
+    bool usesSpecializedPolicy() const { return advance_step != &AntManiaSimulation::advanceGeneric; }  // Last run
+    void setQuiet(bool enabled) { output.setQuiet(enabled); }
+    void setAsyncOutput(bool enabled) { output.setAsync(enabled); }
+    void setSilent(bool enabled);  // No console output at all (ensemble trials)
+    uint64_t getMessageCount() const { return output.getMessageCount(); }
+    void setSeed(uint64_t new_seed);
+    uint64_t getSeed() const { return seed; }
+    uint32_t getColoniesDestroyed() const { return colonies_destroyed; }
+    uint32_t getFightPairs() const { return total_fight_pairs; }
+    bool isColonyDestroyed(uint32_t colony_id) const { return destroyed(colony_id); }
+    uint8_t getLiveMask(uint32_t colony_id) const { return live_masks[colony_id]; }  // Tunnels to live colonies
+    uint32_t getAntsRemaining() const { return alive_ants_count; }
+    uint32_t getIterations() const { return iterations; }
+    uint64_t getAntSteps() const { return total_ant_steps; }
+#ifdef ANT_MANIA_INSTRUMENT
+    Instrumentation& getInstrumentation() { return instrumentation; }
+#endif
+    
+    bool loadMap(const std::string& filename);  // Text or binary, detected from the file's contents
+    bool compileMap(const std::string& filename) const;  // Writes the loaded map in binary form
+    
+    // Runs on an already loaded map shared with other simulations, starting from a fresh state
+    void setGraph(std::shared_ptr<const ColonyGraph> shared_graph);
+    const std::shared_ptr<const ColonyGraph>& getGraph() const { return graph; }
+    
+    // Restores every colony and clears ants and statistics; the graph is kept
+    void reset();
     void createAnts(uint32_t num_ants);
-    void runSimulation();
+    void runSimulation();  // run() with the console observer
+    
+    // Runs to termination, reporting to observer (see simulation_observer.h). Continues
+    // a run already advanced by step(); does nothing once the run has finished.
+    template <typename Observer> void run(Observer& observer);
+    
+    // Resumable runs: advance at most max_iterations, or until the deadline, then return so
+    // the caller can interleave other work. Events are the same as run()'s, and a run driven
+    // in slices of any size ends exactly like an uninterrupted one. Engine, RNG, thread and
+    // memory settings are read when the run starts, so changing them between slices only
+    // affects the next run; an observer may change between calls.
+    template <typename Observer> StepResult step(Observer& observer, uint32_t max_iterations);
+    template <typename Observer> StepResult runUntil(Observer& observer, std::chrono::steady_clock::time_point deadline);
+    template <typename Observer> StepResult runFor(Observer& observer, std::chrono::nanoseconds budget) {
+        return runUntil(observer, std::chrono::steady_clock::now() + budget);
+    }
+    StepResult step(uint32_t max_iterations);             // With the console observer
+    StepResult runFor(std::chrono::nanoseconds budget);  // With the console observer
+    RunState getRunState() const { return run_state; }
+    
+    // Checkpoints hold ants, destroyed colonies, counters and RNG state, never the graph.
+    // A run restored onto the same map continues bit-exactly, with the checkpoint's
+    // RNG, engine kind and fast-forward setting.
+    void setCheckpoint(const std::string& path, uint32_t interval) { checkpoint_path = path; checkpoint_interval = interval; }
+    bool saveCheckpoint(const std::string& path) const;  // Current state, written synchronously
+    bool restoreCheckpoint(const std::string& path);     // The map must already be loaded
     void printRemainingWorld();
     void printStatistics();
 };
+
+template <typename Observer>
+void AntManiaSimulation::run(Observer& observer) {
+    step(observer, UINT32_MAX);  // Runs end long before: every ant makes at most MAX_MOVES moves
+}
+
+template <typename Observer>
+StepResult AntManiaSimulation::step(Observer& observer, uint32_t max_iterations) {
+    if (run_state == RunState::FINISHED) return endSlice(0);
+    beginSlice(observesTrappedAnts<Observer>);
+    
+    for (uint32_t steps = 0; steps < max_iterations; ++steps) {
+        if (!(this->*advance_step)()) {
+            observer.runEnd(finishRun());
+            return endSlice(steps);
+        }
+        
+        if constexpr (observesTrappedAnts<Observer>) {
+            for (const TrappedAnt& ant : trapped_this_iteration) {
+                observer.antTrapped(AntTrappedEvent{iterations, ant.ant_id, ant.colony_id, colonyName(ant.colony_id), ant.moves});
+            }
+        }
+        
+        // Occupancy slots of this iteration's destroyed colonies are still current
+        for (uint32_t colony_id : destroyed_this_iteration) {
+            const ColonyOccupancy& slot = occupancy[colony_id];
+            observer.colonyDestroyed(ColonyDestroyedEvent{iterations, colony_id, colonyName(colony_id),
+                                                   slot.ant_ids[0], slot.ant_ids[1], slot.count});
+        }
+        
+        observer.iterationEnd(IterationEndEvent{iterations, alive_ants_count, colonies_destroyed, total_ant_steps});
+        endIteration();
+    }
+    return endSlice(max_iterations);
+}
+
+template <typename Observer>
+StepResult AntManiaSimulation::runUntil(Observer& observer, std::chrono::steady_clock::time_point deadline) {
+    // Iterations go in chunks, so the clock is read per chunk, not per iteration. A chunk
+    // doubles while it takes under an eighth of the time left and halves past a half, so
+    // chunks stay around a quarter of the remaining budget; only a single iteration longer
+    // than the time left can overshoot by more.
+    constexpr uint32_t MAX_CHUNK = 4096;
+    StepResult total = step(observer, 0);
+    uint32_t chunk = 1;
+    auto now = std::chrono::steady_clock::now();
+    while (!total.finished && now < deadline) {
+        const auto chunk_start = now;
+        StepResult slice = step(observer, chunk);
+        slice.steps += total.steps;
+        total = slice;
+        now = std::chrono::steady_clock::now();
+        
+        const auto elapsed = now - chunk_start;
+        const auto remaining = deadline - now;
+        if (elapsed * 8 < remaining) {
+            chunk = std::min(chunk * 2, MAX_CHUNK);
+        } else if (elapsed * 2 > remaining) {
+            chunk = std::max(chunk / 2, 1u);
+        }
+    }
+    return total;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Precompiled binary map format.
+// A text map is parsed once (`ant_mania --compile-map in.txt out.antmap`) into a
+// file the loader can mmap and use without tokenizing or hashing names. All
+// integers are in host byte order (checked via byte_order); sections follow the
+// header back to back, each 8-byte aligned:
+//
+//   connections      uint32_t[colony_count * 4]  north, south, east, west; UINT32_MAX = none
+//   reverse_offsets  uint32_t[colony_count + 1]  CSR index of incoming tunnels
+//   reverse_edges    uint32_t[edge_count]        source << 2 | dir, ascending within each colony
+//   name_offsets     uint32_t[colony_count + 1]  colony c's name is names[name_offsets[c] .. name_offsets[c + 1])
+//   names            char[name_bytes]            packed, no separators
+
+static constexpr char BINARY_MAP_MAGIC[8] = {'A', 'N', 'T', 'M', 'A', 'P', '\0', '\x1a'};
+static constexpr uint32_t BINARY_MAP_VERSION = 1;
+static constexpr uint32_t BINARY_MAP_BYTE_ORDER = 0x01020304;
+
+struct BinaryMapHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t colony_count;
+    uint32_t edge_count;
+    uint64_t name_bytes;
+    uint64_t file_size;   // Detects truncated files
+};
+
+// Sections of a binary map, either pointing into a mapped file or into memory being written
+struct BinaryMapView {
+    uint32_t colony_count = 0;
+    uint32_t edge_count = 0;
+    uint64_t name_bytes = 0;
+    const uint32_t* connections = nullptr;
+    const uint32_t* reverse_offsets = nullptr;
+    const uint32_t* reverse_edges = nullptr;
+    const uint32_t* name_offsets = nullptr;
+    const char* names = nullptr;
+};
+
+// True if data starts with the binary map magic (any version)
+bool isBinaryMap(std::string_view data);
+
+// Validates header, sizes and section contents and points view at the sections.
+// data must stay alive (and 8-byte aligned, as mmap guarantees) while view is used.
+bool parseBinaryMap(std::string_view data, BinaryMapView& view, std::string& error);
+
+bool writeBinaryMap(const std::string& filename, const BinaryMapView& view);
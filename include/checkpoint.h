@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simulation checkpoints: everything a run needs to continue bit-exactly, and
+// nothing the immutable ColonyGraph already holds. Live masks are rebuilt from the
+// graph and the destroyed bitmap on restore, so a checkpoint is about 10 bytes per
+// ant slot plus one bit per colony. All integers are in host byte order; sections
+// follow the header back to back, each 8-byte aligned:
+//
+//   colony_ids      uint32_t[ant_count]   DEAD_ANT for killed, not yet compacted ants
+//   move_counts     uint16_t[ant_count]
+//   ant_ids         uint32_t[ant_count]
+//   destroyed_bits  uint64_t[(colony_count + 63) / 64]
+//   mt_state        char[mt_state_bytes]  std::mt19937_64 text state (mt19937 runs only)
+
+static constexpr char CHECKPOINT_MAGIC[8] = {'A', 'N', 'T', 'C', 'K', 'P', 'T', '\x1a'};
+static constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+// In-memory form of a checkpoint. Refilled in place, so taking one allocates nothing
+// once the vectors have grown to the run's size.
+struct SimulationSnapshot {
+    // Identifies the map and configuration the state belongs to
+    uint32_t colony_count = 0;
+    uint32_t edge_count = 0;
+    uint8_t colony_order = 0;
+    uint8_t rng_kind = 0;
+    uint8_t engine = 0;
+    uint8_t fast_forward = 0;
+
+    // Generators; counter draws are stateless beyond the seed
+    uint64_t seed = 0;
+    std::array<uint64_t, 4> xoshiro_state{};
+    std::string mt_state;
+
+    // Counters
+    uint32_t iterations = 0;  // Completed iterations
+    uint32_t total_ants = 0;
+    uint32_t colonies_destroyed = 0;
+    uint32_t total_fight_pairs = 0;
+    uint32_t alive_ants_count = 0;
+    uint32_t max_moves_ants_count = 0;
+    uint32_t dead_count = 0;
+    uint64_t total_ant_steps = 0;
+    uint64_t message_count = 0;
+
+    // Fast-forward schedule (it draws from xoshiro, so its timing is part of the state)
+    uint32_t fast_forward_interval = 0;
+    uint32_t fast_forward_countdown = 0;
+    uint32_t last_check_destroyed = 0;
+    uint32_t last_check_alive = 0;
+
+    std::vector<uint32_t> colony_ids;
+    std::vector<uint16_t> move_counts;
+    std::vector<uint32_t> ant_ids;
+    std::vector<uint64_t> destroyed_bits;
+};
+
+// Writes to filename + ".tmp" and renames it over filename, so a crash mid-write
+// leaves the previous checkpoint intact
+bool writeCheckpoint(const std::string& filename, const SimulationSnapshot& snapshot);
+bool readCheckpoint(const std::string& filename, SimulationSnapshot& snapshot, std::string& error);
+
+// Background checkpoint writer. The simulation fills a snapshot and swaps it in;
+// the file is written on this thread while the simulation keeps going. Only one
+// write is in flight: submitting while one is still running waits for it.
+class CheckpointWriter {
+private:
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    SimulationSnapshot pending;
+    std::string pending_path;
+    bool pending_ready;
+    bool stopping;
+    bool failed;  // Some write since the last wait() failed
+
+    void writerLoop();
+
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Takes snapshot's contents and hands back the previous buffer for reuse
+    void submit(SimulationSnapshot& snapshot, const std::string& filename);
+
+    // Blocks until nothing is being written; false if any write failed since the last call
+    bool wait();
+};
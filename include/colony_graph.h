@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "huge_page_arena.h"
+#include "mapped_file.h"
+
+enum class Direction : uint8_t {
+    NORTH = 0,
+    SOUTH = 1,
+    EAST = 2,
+    WEST = 3,
+    INVALID = 255
+};
+
+// Internal numbering of colonies. Reordering only changes memory layout:
+// names, ant placement and every printed order still follow the file.
+enum class ColonyOrder : uint8_t {
+    FILE = 0,  // IDs in file order
+    BFS = 1,   // Breadth-first over tunnels (both directions), components in file order
+    RCM = 2    // Reverse Cuthill-McKee: BFS from a peripheral colony, low-degree neighbours first, reversed
+};
+
+// One colony's tunnels: north, south, east, west -> colony IDs. ColonyId is
+// uint16_t or uint32_t; its all-ones value means no connection.
+template <typename ColonyId>
+using Connections = std::array<ColonyId, 4>;
+
+// Immutable map: connections, reverse adjacency and colony names.
+// Loaded once (text or binary) and shared read-only by any number of simulations.
+// Connections are stored 16-bit when the map has fewer than 65535 colonies, halving
+// the table. Per-run state is just a live mask per colony plus a destroyed bitmap,
+// so resetting a run copies one byte per colony.
+class ColonyGraph {
+private:
+    // Holds the tables the hot loop reads (connections, live masks, reverse index) in one
+    // huge-page block; names and the reorder mapping are cold and stay on the heap
+    HugePageArena memory;
+
+    // Exactly one table is in use, chosen at load time (see hasNarrowIds())
+    ArenaVector<Connections<uint16_t>> narrow_connections;
+    ArenaVector<Connections<uint32_t>> wide_connections;
+    ArenaVector<uint8_t> live_masks;  // Bit d set if tunnel d exists (nothing destroyed yet)
+
+    // Reverse adjacency (CSR): incoming tunnels of colony c are
+    // reverse_edges[reverse_offsets[c] .. reverse_offsets[c + 1]), each packed as source << 2 | dir
+    ArenaVector<uint32_t> reverse_offsets;
+    ArenaVector<uint32_t> reverse_edges;
+
+    // Colony c's name is name_blob[name_offsets[c] .. name_offsets[c + 1]). Text maps
+    // fill the owned_* buffers; binary maps point straight into the mapped file.
+    std::vector<uint32_t> owned_name_offsets;
+    std::string owned_names;
+    MappedFile binary_map;
+    const uint32_t* name_offsets;
+    const char* name_blob;
+
+    // After reorder(): internal ID <-> position in the file. Empty means identity.
+    std::vector<uint32_t> file_index_of;
+    std::vector<uint32_t> colony_at_file_index;
+
+    void parseMap(std::string_view text);
+    bool parseMapParallel(std::string_view text, uint32_t threads);
+    bool loadBinaryMap(MappedFile&& file, const std::string& filename);
+    void assignConnections(std::vector<Connections<uint32_t>>&& connections);
+    void buildNeighborIndex();
+    std::vector<uint32_t> traversalOrder(ColonyOrder order) const;
+
+public:
+    static constexpr uint32_t NO_CONNECTION = UINT32_MAX;
+    static constexpr uint32_t NARROW_ID_LIMIT = std::numeric_limits<uint16_t>::max();  // Colony count below this
+
+    ColonyGraph();
+
+    // Name pointers refer into this object's own buffers
+    ColonyGraph(const ColonyGraph&) = delete;
+    ColonyGraph& operator=(const ColonyGraph&) = delete;
+
+    // Page backing for the tables of the next load()
+    void setMemoryOptions(const MemoryOptions& options) { memory.setOptions(options); }
+    const HugePageArena& getMemory() const { return memory; }
+
+    // Text or binary, detected from the file's contents. Text maps of a few MB and up are
+    // parsed on `threads` threads, with the same IDs as the sequential parser.
+    bool load(const std::string& filename, uint32_t threads = 1);
+    bool compile(const std::string& filename) const;  // Writes the map in binary form (file order only)
+
+    // Renumbers colonies so tunnels mostly connect nearby IDs
+    void reorder(ColonyOrder order);
+    bool isReordered() const { return !file_index_of.empty(); }
+    uint32_t fileIndex(uint32_t colony_id) const { return file_index_of.empty() ? colony_id : file_index_of[colony_id]; }
+    uint32_t colonyAtFileIndex(uint32_t index) const {
+        return colony_at_file_index.empty() ? index : colony_at_file_index[index];
+    }
+
+    uint32_t size() const { return static_cast<uint32_t>(live_masks.size()); }
+    uint32_t edgeCount() const { return static_cast<uint32_t>(reverse_edges.size()); }
+    const ArenaVector<uint8_t>& initialLiveMasks() const { return live_masks; }
+    
+    // Hot loops are instantiated per ID width and index the matching table directly
+    bool hasNarrowIds() const { return !narrow_connections.empty(); }
+    template <typename ColonyId> const Connections<ColonyId>* connectionTable() const {
+        if constexpr (sizeof(ColonyId) == sizeof(uint16_t)) {
+            return narrow_connections.data();
+        } else {
+            return wide_connections.data();
+        }
+    }
+    
+    // Width-independent access for cold paths; missing tunnels read as NO_CONNECTION
+    uint32_t connection(uint32_t colony_id, uint8_t dir) const {
+        if (hasNarrowIds()) {
+            uint16_t target = narrow_connections[colony_id][dir];
+            return target == std::numeric_limits<uint16_t>::max() ? NO_CONNECTION : target;
+        }
+        return wide_connections[colony_id][dir];
+    }
+    Connections<uint32_t> connections(uint32_t colony_id) const {
+        return {connection(colony_id, 0), connection(colony_id, 1), connection(colony_id, 2), connection(colony_id, 3)};
+    }
+    size_t connectionTableBytes() const {
+        return narrow_connections.size() * sizeof(Connections<uint16_t>)
+             + wide_connections.size() * sizeof(Connections<uint32_t>);
+    }
+
+    // Names stay in file order; only the ID mapping changes when reordered
+    std::string_view name(uint32_t colony_id) const {
+        uint32_t index = fileIndex(colony_id);
+        return std::string_view(name_blob + name_offsets[index], name_offsets[index + 1] - name_offsets[index]);
+    }
+
+    // Incoming tunnels of a colony, packed as source << 2 | dir
+    const uint32_t* incomingBegin(uint32_t colony_id) const { return reverse_edges.data() + reverse_offsets[colony_id]; }
+    const uint32_t* incomingEnd(uint32_t colony_id) const { return reverse_edges.data() + reverse_offsets[colony_id + 1]; }
+
+    static Direction direction_to_enum(std::string_view direction);
+    static constexpr const char* enum_to_direction(Direction dir) {
+        switch (dir) {
+            case Direction::NORTH: return "north";
+            case Direction::SOUTH: return "south";
+            case Direction::EAST: return "east";
+            case Direction::WEST: return "west";
+            case Direction::INVALID: return "invalid";
+        }
+        return "invalid";  // fallback
+    }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "ant_mania.h"
+
+// Monte Carlo ensembles: many independent trials over one shared ColonyGraph.
+// Each worker thread owns one AntManiaSimulation and reuses it for every trial it
+// runs (reset() is an array copy), pulling trial indices from a shared counter.
+// Trial t always runs with seed base_seed + t, so results don't depend on the
+// thread count or on which worker ran which trial.
+
+struct EnsembleConfig {
+    uint32_t trials = 100;
+    uint32_t ants = 100;
+    uint64_t base_seed = 1;
+    uint32_t threads = 1;
+    SimulationEngine engine = SimulationEngine::TWO_PASS;  // PARALLEL runs as FUSED with COUNTER draws
+    RngKind rng = RngKind::XOSHIRO;
+    bool fast_forward = true;
+    bool vector_moves = true;  // Ignored where AVX2 is missing
+    MemoryOptions memory;      // Each worker's run state; the graph keeps its own
+};
+
+struct TrialResult {
+    uint64_t seed;
+    uint32_t colonies_destroyed;
+    uint32_t iterations;
+    uint32_t ants_remaining;
+    uint32_t fight_pairs;
+};
+
+struct EnsembleResult {
+    std::vector<TrialResult> trials;         // In trial order
+    std::vector<uint32_t> destroyed_counts;  // Per colony: number of trials that destroyed it
+    double elapsed_ms = 0;
+};
+
+// Summary of one statistic across trials (nearest-rank percentiles)
+struct DistributionStats {
+    double mean;
+    double stddev;
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+};
+
+EnsembleResult runEnsemble(std::shared_ptr<const ColonyGraph> graph, const EnsembleConfig& config);
+
+DistributionStats describe(std::vector<uint32_t> values);
+
+// Distribution table, destroyed-colony histogram and the most frequently destroyed colonies
+void printEnsembleSummary(const EnsembleResult& result, const ColonyGraph& graph, std::ostream& os);
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Fast random number generation for the move hot path.
+// xoshiro256** (Blackman & Vigna) is several times cheaper per draw than
+// std::mt19937_64 and has a 32-byte state that stays in registers.
+
+enum class RngKind : uint8_t {
+    XOSHIRO = 0,  // xoshiro256** with batched multiply-shift bounded draws
+    MT19937 = 1,  // std::mt19937_64 with std::uniform_int_distribution (reference path)
+    COUNTER = 2   // Stateless per-ant streams, independent of processing order
+};
+
+// splitmix64 step, used to expand a single 64-bit seed into generator state
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Maps a uniform 32-bit value onto [0, bound) with one multiply and a shift
+// (Lemire). Bias is at most bound / 2^32, negligible for bound <= 4.
+inline uint32_t boundedDraw(uint32_t random32, uint32_t bound) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(random32) * bound) >> 32);
+}
+
+// Counter-based draw: a stateless hash of (seed, stream, counter). Each ant gets
+// its own stream indexed by its move number, so results do not depend on which
+// thread moves it or in what order.
+inline uint32_t counterDraw(uint64_t seed, uint32_t stream, uint32_t counter) {
+    uint64_t state = seed ^ (((static_cast<uint64_t>(stream) << 32) | counter) * 0xD1B54A32D192ED03ULL);
+    return static_cast<uint32_t>(splitmix64(state) >> 32);
+}
+
+// Satisfies UniformRandomBitGenerator, so it also works with <random> distributions
+class Xoshiro256 {
+private:
+    uint64_t s[4];
+
+    static constexpr uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (auto& word : s) word = splitmix64(seed);
+    }
+
+    // Raw state, saved and restored by checkpoints
+    std::array<uint64_t, 4> state() const { return {s[0], s[1], s[2], s[3]}; }
+    void setState(const std::array<uint64_t, 4>& state) {
+        for (int i = 0; i < 4; ++i) s[i] = state[i];
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Fills out[0, n) with uniform 32-bit values, two per 64-bit draw
+    void fill32(uint32_t* out, size_t n) {
+        size_t i = 0;
+        for (; i + 1 < n; i += 2) {
+            uint64_t r = (*this)();
+            out[i] = static_cast<uint32_t>(r);
+            out[i + 1] = static_cast<uint32_t>(r >> 32);
+        }
+        if (i < n) {
+            out[i] = static_cast<uint32_t>((*this)() >> 32);
+        }
+    }
+};
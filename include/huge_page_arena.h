@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Page backing for large simulation buffers
+enum class HugePages : uint8_t {
+    OFF = 0,          // Plain heap allocations, as std::allocator
+    TRANSPARENT = 1,  // Anonymous mapping with madvise(MADV_HUGEPAGE)
+    EXPLICIT = 2      // MAP_HUGETLB from the reserved 2 MB pool, falling back to TRANSPARENT
+};
+
+struct MemoryOptions {
+    HugePages huge_pages = HugePages::TRANSPARENT;
+    bool prefault = false;    // Fault every page in when the block is mapped, not on first touch
+    bool numa_local = false;  // Bind the block to the NUMA node of the thread that maps it
+};
+
+// How a block ended up backed; a request can fall back all the way to normal pages
+enum class PageBacking : uint8_t { EXPLICIT, TRANSPARENT, NORMAL };
+
+struct ArenaStats {
+    size_t blocks = 0;
+    size_t mapped_bytes = 0;
+    size_t used_bytes = 0;
+    size_t explicit_bytes = 0;     // Mapped from the hugetlb pool
+    size_t transparent_bytes = 0;  // Mapped with MADV_HUGEPAGE (see residentHugeBytes())
+};
+
+// Bump allocator over a few large mappings. An owner reserve()s its working set up
+// front, so the buffers it then allocates sit together in one region that huge pages
+// can cover. Allocations that do not fit, and everything when huge pages are off or
+// the working set is under one huge page, go to the heap. Space freed out of order is
+// only reclaimed when the arena is destroyed; owners size their buffers once and reuse them.
+class HugePageArena {
+private:
+    struct Block {
+        char* base;
+        size_t size;
+        size_t used;
+        PageBacking backing;
+    };
+
+    MemoryOptions options;
+    std::vector<Block> blocks;  // The last one is the one being filled
+
+    bool mapBlock(size_t bytes);
+
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+    static constexpr size_t ALIGNMENT = 64;
+
+    explicit HugePageArena(const MemoryOptions& memory_options = {});
+    ~HugePageArena();
+
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+
+    // Applies to blocks mapped from now on
+    void setOptions(const MemoryOptions& memory_options) { options = memory_options; }
+    const MemoryOptions& getOptions() const { return options; }
+
+    // Makes room for `bytes` of upcoming allocations in one block
+    void reserve(size_t bytes);
+
+    void* allocate(size_t bytes);
+    void deallocate(void* pointer, size_t bytes) noexcept;
+    bool owns(const void* pointer) const;
+
+    ArenaStats stats() const;
+    size_t residentHugeBytes() const;  // Huge pages actually backing the blocks (Linux smaps)
+
+    static constexpr size_t roundUp(size_t bytes) { return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+};
+
+// std::allocator drop-in over an arena; a null arena means the heap
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    HugePageArena* arena;
+
+    ArenaAllocator() noexcept : arena(nullptr) {}
+    explicit ArenaAllocator(HugePageArena* owner) noexcept : arena(owner) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena ? arena->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* pointer, size_t n) noexcept {
+        if (arena) {
+            arena->deallocate(pointer, n * sizeof(T));
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Bytes a vector still needs to hold n elements, for sizing a reserve()
+template <typename T>
+size_t arenaGrowth(const ArenaVector<T>& vector, size_t n) {
+    return vector.capacity() < n ? HugePageArena::roundUp(n * sizeof(T)) : 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Hot-path instrumentation for runSimulation.
+// Built with -DANT_MANIA_INSTRUMENT (cmake -DANT_MANIA_INSTRUMENT=ON) the simulation
+// records per-iteration counters and phase timings into a ring buffer, and samples
+// Linux hardware counters per phase when perf_event_open is available. Without the
+// define every ANT_INSTRUMENT(...) hook expands to nothing and the simulation carries
+// no Instrumentation member, so release builds are unchanged.
+
+#ifdef ANT_MANIA_INSTRUMENT
+#define ANT_INSTRUMENT(...) __VA_ARGS__
+#else
+#define ANT_INSTRUMENT(...)
+#endif
+
+// Where an iteration's time goes
+enum class Phase : uint8_t {
+    MOVE = 0,         // Moving ants (including batched RNG draws)
+    COLLIDE = 1,      // Occupancy counting, collision resolution and destruction
+    MAINTENANCE = 2,  // Fast-forward checks, compaction, progress output
+    NONE = 3
+};
+
+static constexpr size_t PHASE_COUNT = 3;
+
+// Hardware events sampled per phase
+enum class PerfEvent : uint8_t {
+    CYCLES = 0,
+    CACHE_MISSES = 1,
+    BRANCH_MISSES = 2,
+    DTLB_MISSES = 3   // Data TLB read misses; what huge pages are meant to cut
+};
+
+static constexpr size_t PERF_EVENT_COUNT = 4;
+
+// Group of hardware counters for the calling thread, read with a single syscall.
+// open() fails quietly (no permission, no PMU, non-Linux), leaving it inactive.
+class PerfCounters {
+private:
+    int fds[PERF_EVENT_COUNT];
+    bool active;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool open();
+    void close();
+    bool isActive() const { return active; }
+
+    // Current counter values; zeros when inactive
+    void read(uint64_t (&values)[PERF_EVENT_COUNT]) const;
+};
+
+// One iteration's counters
+struct IterationSample {
+    uint32_t iteration;
+    uint32_t live_ants;     // Alive at the start of the iteration
+    uint32_t moved;         // Successful ant moves (including fast-forwarded ones)
+    uint32_t touched;       // Colonies that received at least one ant
+    uint32_t destroyed;     // Colonies destroyed
+    uint64_t phase_ns[PHASE_COUNT];
+    uint64_t perf[PHASE_COUNT][PERF_EVENT_COUNT];
+};
+
+// Per-iteration ring buffer plus running totals over the whole run.
+// Only the last `capacity` iterations are kept for the CSV trace; the summary
+// covers every iteration.
+class Instrumentation {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<IterationSample> ring;
+    uint64_t recorded;   // Iterations recorded since start()
+
+    IterationSample current;
+    Phase current_phase;
+    Clock::time_point phase_start;
+    uint64_t phase_perf_start[PERF_EVENT_COUNT];
+    uint64_t steps_at_start;
+    uint32_t destroyed_at_start;
+
+    // Totals over every recorded iteration
+    uint64_t total_ns[PHASE_COUNT];
+    uint64_t total_perf[PHASE_COUNT][PERF_EVENT_COUNT];
+    uint64_t total_live;
+    uint64_t total_moved;
+    uint64_t total_touched;
+    uint64_t total_destroyed;
+
+    bool perf_requested;
+    PerfCounters perf;
+
+    void closePhase();
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit Instrumentation(size_t capacity = DEFAULT_CAPACITY);
+
+    // Hardware counters are opened by start(); off by default since each phase switch costs a syscall
+    void setPerfCounters(bool enabled) { perf_requested = enabled; }
+    bool perfCountersActive() const { return perf.isActive(); }
+
+    // Clears all samples and totals
+    void start();
+    void stop();
+
+    void beginIteration(uint32_t iteration, uint32_t live_ants, uint64_t ant_steps, uint32_t colonies_destroyed);
+    void enterPhase(Phase phase);
+    void addTouched(size_t colonies) { current.touched += static_cast<uint32_t>(colonies); }
+    void endIteration(uint64_t ant_steps, uint32_t colonies_destroyed);
+
+    uint64_t iterationsRecorded() const { return recorded; }
+    size_t size() const;
+    const IterationSample& sample(size_t i) const;  // Oldest retained first
+
+    void printSummary(std::ostream& os) const;
+    void writeCsv(std::ostream& os) const;
+    bool writeCsv(const std::string& filename) const;
+};
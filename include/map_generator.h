@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Synthetic map generator for scaling experiments.
+// Output follows the map spec: unique alphabetic colony names, and every tunnel
+// is written from both ends (a north=b implies b south=a). Colony i is named
+// colonyNameFor(i), so generated maps are reproducible from (config, seed).
+
+enum class MapTopology : uint8_t {
+    GRID = 0,    // Near-square lattice, row-major; neighbours are spatially local
+    RANDOM = 1   // Two random Hamiltonian paths (north/south and east/west); no locality
+};
+
+struct MapGeneratorConfig {
+    uint32_t colonies = 10000;
+    MapTopology topology = MapTopology::GRID;
+    double missing_edge_ratio = 0.0;  // Fraction of tunnels dropped (both directions)
+    uint64_t seed = 1;
+    bool shuffle_lines = false;       // Write colonies in random order (IDs follow file order)
+};
+
+// "Col" followed by the index in base 26 ('a'..'z'), least significant first
+std::string colonyNameFor(uint32_t index);
+
+bool generateMap(const MapGeneratorConfig& config, std::ostream& out);
+bool generateMap(const MapGeneratorConfig& config, const std::string& filename);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fast_rng.h"
+
+// Vectorized move step: eight ants per iteration with AVX2 gathers for the
+// live masks, direction table and connection rows. It consumes the same draw per
+// ant as the scalar stepAnt() (random_batch for XOSHIRO, counterDraw for COUNTER)
+// and applies the same rules, so positions and counters match it exactly.
+// Compiled for AVX2 regardless of build flags and selected at runtime.
+
+// An ant that found no live tunnel, recorded for observers that ask for it
+struct TrappedAnt {
+    uint32_t ant_id;
+    uint32_t colony_id;  // Where it was trapped
+    uint32_t moves;
+};
+
+// Arrays the kernel reads and writes: the ant store plus this run's colony state
+struct MoveBatch {
+    uint32_t* colony_ids;       // DEAD_ANT (all ones) for dead ants
+    uint16_t* move_counts;
+    const uint32_t* ant_ids;
+    const uint32_t* random;     // One draw per ant slot (XOSHIRO)
+    const uint8_t* live_masks;  // Size padded to a multiple of 4
+    const void* connections;    // Connections<ColonyId> table
+    uint64_t seed;              // COUNTER draws
+    uint16_t max_moves;
+    TrappedAnt* trapped;        // Optional: receives tally.trapped records, in ant order
+};
+
+// Counter updates for the moved range, applied by the caller
+struct MoveTally {
+    uint32_t moved = 0;           // Successful moves
+    uint32_t reached_max = 0;     // Moves that hit max_moves
+    uint32_t trapped = 0;         // Ants with no live neighbour; now DEAD_ANT
+    uint32_t trapped_at_max = 0;  // ...of which had already reached max_moves
+};
+
+// Largest map the kernel handles: slot indices (colony * 4 + dir) must fit in int32
+static constexpr uint32_t MOVE_KERNEL_MAX_COLONIES = 1u << 29;
+
+bool moveKernelAvailable();  // CPU supports AVX2
+
+// Moves ants [begin, begin + 8k) for the largest k that fits before end and returns
+// the first index not processed, which the caller finishes with the scalar step.
+template <RngKind KIND, typename ColonyId>
+uint32_t moveAntsVectorized(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally);
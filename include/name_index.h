@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Flat open-addressing index from colony name to ID, used while parsing text maps.
+// Names themselves live in the caller's arena (one blob plus an offset table); a
+// slot is just the name's precomputed hash and its ID, 8 bytes, probed linearly.
+// Growing re-places slots by their stored hash, so no name is ever hashed twice.
+class NameIndex {
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;  // EMPTY if unused
+    };
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    std::vector<Slot> slots;  // Power-of-two size, at most half full
+    size_t count;
+    const std::string& names;
+    const std::vector<uint32_t>& offsets;  // Name of ID i is names[offsets[i] .. offsets[i + 1])
+
+    std::string_view nameOf(uint32_t id) const {
+        return std::string_view(names.data() + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+    void rehash(size_t capacity);
+
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    NameIndex(const std::string& name_blob, const std::vector<uint32_t>& name_offsets);
+
+    static uint32_t hash(std::string_view name);
+
+    void reserve(size_t expected);  // Room for this many names without growing
+    bool insert(std::string_view name, uint32_t hash, uint32_t id);  // False if repeated; it takes the new ID
+    uint32_t find(std::string_view name, uint32_t hash) const;
+    uint32_t find(std::string_view name) const { return find(name, hash(name)); }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+
+// Buffered writer for simulation output (destruction messages, progress, final map).
+// Text is appended to a large preallocated buffer and written out in big chunks,
+// either inline or by a background writer thread (double-buffered), so the hot
+// loop never flushes the stream. In quiet mode destruction messages are counted
+// but not formatted.
+class OutputSink {
+private:
+    std::ostream* stream;
+    std::unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used;
+    
+    bool quiet;
+    uint64_t message_count;
+    
+    // Background writer: the full buffer is swapped into `pending` and written there
+    bool async;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::unique_ptr<char[]> pending;
+    size_t pending_size;
+    bool pending_ready;
+    bool stopping;
+    
+    void handOff();
+    void waitForWriter();
+    void writerLoop();
+    
+    char* reserve(size_t n) {
+        if (used + n > capacity) handOff();
+        return buffer.get() + used;
+    }
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+    
+    explicit OutputSink(std::ostream& os, size_t buffer_capacity = DEFAULT_CAPACITY);
+    ~OutputSink();
+    
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    
+    void setStream(std::ostream& os);
+    void setQuiet(bool enabled) { quiet = enabled; }
+    void setAsync(bool enabled);
+    bool isQuiet() const { return quiet; }
+    uint64_t getMessageCount() const { return message_count; }
+    void resetMessageCount() { message_count = 0; }
+    void setMessageCount(uint64_t count) { message_count = count; }  // Resuming a checkpoint
+    
+    OutputSink& write(std::string_view text);
+    OutputSink& write(char c) {
+        *reserve(1) = c;
+        used++;
+        return *this;
+    }
+    OutputSink& writeUint(uint64_t value);
+    
+    // "<colony> has been destroyed by ant <a> and ant <b>!\n", or just counted when quiet
+    void destructionMessage(std::string_view colony, uint32_t ant_a, uint32_t ant_b);
+    
+    // Writes everything buffered so far and flushes the stream
+    void flush();
+};
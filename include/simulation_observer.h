@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "output_sink.h"
+
+// Typed simulation events. AntManiaSimulation::run() is a template on the observer,
+// so each hook is a direct, inlinable call: NullObserver's empty hooks compile away,
+// and the engine itself is compiled once regardless of the observer.
+//
+// Within an iteration, events arrive as: every ant trapped (ant order, then ants trapped
+// by the fast-forward pass), every colony destroyed (file order), then iterationEnd.
+// String views point into the map and stay valid while it is loaded.
+
+struct ColonyDestroyedEvent {
+    uint32_t iteration;
+    uint32_t colony_id;       // Internal ID, as taken by isColonyDestroyed()
+    std::string_view colony;  // Name in the map file
+    uint32_t ant_a;           // First two ants to arrive, as in the console message
+    uint32_t ant_b;
+    uint32_t ants;            // Ants killed with the colony (every pair fought)
+};
+
+// An ant with no live tunnel out of its colony; it dies where it stands
+struct AntTrappedEvent {
+    uint32_t iteration;
+    uint32_t ant_id;
+    uint32_t colony_id;
+    std::string_view colony;
+    uint32_t moves;           // Moves made before it was trapped
+};
+
+struct IterationEndEvent {
+    uint32_t iteration;
+    uint32_t ants_alive;
+    uint32_t colonies_destroyed;
+    uint64_t ant_steps;
+};
+
+struct RunEndEvent {
+    uint32_t iterations;      // Same count as "Total iterations"
+    uint32_t ants_remaining;
+    uint32_t colonies_destroyed;
+    uint32_t fight_pairs;
+    uint64_t ant_steps;
+    uint64_t microseconds;
+};
+
+// Ignores everything. Observers derive from it and hide only the hooks they need.
+struct NullObserver {
+    struct Ignored {};  // Marks the inherited antTrapped, see observesTrappedAnts
+    
+    void colonyDestroyed(const ColonyDestroyedEvent&) {}
+    Ignored antTrapped(const AntTrappedEvent&) { return {}; }
+    void iterationEnd(const IterationEndEvent&) {}
+    void runEnd(const RunEndEvent&) {}
+};
+
+// Type of observer.antTrapped(event), whatever overload or template it resolves to
+template <typename Observer, typename = void>
+struct TrappedHookResult {
+    using type = NullObserver::Ignored;  // No hook at all
+};
+template <typename Observer>
+struct TrappedHookResult<Observer, std::void_t<decltype(std::declval<Observer&>().antTrapped(std::declval<const AntTrappedEvent&>()))>> {
+    using type = decltype(std::declval<Observer&>().antTrapped(std::declval<const AntTrappedEvent&>()));
+};
+
+// Trapped ants are only recorded for observers whose call reaches a hook of their own
+// rather than NullObserver's
+template <typename Observer>
+inline constexpr bool observesTrappedAnts =
+    !std::is_same_v<typename TrappedHookResult<Observer>::type, NullObserver::Ignored>;
+
+// The command-line output: destruction messages and progress lines through the sink,
+// then the summary on std::cout. Nothing at all when silent.
+class ConsoleObserver : public NullObserver {
+private:
+    OutputSink& output;
+    bool silent;
+
+public:
+    static constexpr uint32_t PROGRESS_INTERVAL = 10000;
+
+    ConsoleObserver(OutputSink& sink, bool silent_output) : output(sink), silent(silent_output) {}
+
+    void colonyDestroyed(const ColonyDestroyedEvent& event) {
+        output.destructionMessage(event.colony, event.ant_a, event.ant_b);
+    }
+
+    void iterationEnd(const IterationEndEvent& event) {
+        if (event.iteration % PROGRESS_INTERVAL == 0 && !silent) {
+            output.write("Iteration ").writeUint(event.iteration).write(": ").writeUint(event.ants_alive)
+                  .write(" ants alive, ").writeUint(event.colonies_destroyed).write(" colonies destroyed\n");
+        }
+    }
+
+    void runEnd(const RunEndEvent& event);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fast_rng.h"
+
+// How each iteration's move and collision phases are scheduled
+enum class SimulationEngine : uint8_t {
+    TWO_PASS = 0,  // moveAnts() then checkCollisions(), each streaming all ants
+    FUSED = 1,     // Each move claims its destination's occupancy slot immediately
+    PARALLEL = 2   // Moves and collision counting split across a thread pool (always COUNTER draws)
+};
+
+// An optional feature of the iteration path: compiled in, compiled out, or left to
+// the simulation's runtime flag (the generic instantiations)
+enum class Toggle : uint8_t { OFF, ON, RUNTIME };
+
+constexpr bool enabled(Toggle toggle, bool flag) {
+    return toggle == Toggle::ON || (toggle == Toggle::RUNTIME && flag);
+}
+
+// Compile-time configuration of one iteration. The iteration functions are templates
+// on a policy, so engine, RNG and connection width are constants inside them and a
+// feature a policy turns off leaves no check behind. The move limit (MAX_MOVES) and
+// the termination rule are constants for every policy.
+template <SimulationEngine ENGINE, RngKind KIND, typename ColonyIdType,
+          Toggle VECTOR_MOVES = Toggle::RUNTIME, Toggle FAST_FORWARD = Toggle::RUNTIME,
+          Toggle TRAPPED_EVENTS = Toggle::RUNTIME>
+struct SimulationPolicy {
+    static constexpr SimulationEngine engine = ENGINE;
+    static constexpr RngKind rng = ENGINE == SimulationEngine::PARALLEL ? RngKind::COUNTER : KIND;
+    using ColonyId = ColonyIdType;
+
+    // mt19937 draws depend on the order ants are visited, so they never use the kernel
+    static constexpr Toggle vector_moves = rng == RngKind::MT19937 ? Toggle::OFF : VECTOR_MOVES;
+    static constexpr Toggle fast_forward = FAST_FORWARD;
+    static constexpr Toggle trapped_events = TRAPPED_EVENTS;  // Record trapped ants for the observer
+};
+
+// Every feature behind its runtime flag; engine, RNG and width are picked each iteration
+template <SimulationEngine ENGINE, RngKind KIND, typename ColonyId>
+using GenericPolicy = SimulationPolicy<ENGINE, KIND, ColonyId>;
+
+// The default configuration (AVX2 moves, fast-forward, no trapped-ant events) with
+// everything fixed; a run is dispatched to one of these once, at its start
+template <SimulationEngine ENGINE, RngKind KIND, typename ColonyId>
+using SpecializedPolicy = SimulationPolicy<ENGINE, KIND, ColonyId, Toggle::ON, Toggle::ON, Toggle::OFF>;
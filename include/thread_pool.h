@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal fork-join pool for the parallel engine.
+// run() hands the same task to the first `active` workers, with the calling
+// thread acting as worker 0, and returns once all of them have finished.
+class ThreadPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    
+    const std::function<void(uint32_t)>* task;
+    uint64_t generation;      // Bumped once per run() to wake workers
+    uint32_t active_workers;
+    uint32_t pending;         // Helper workers still running the current task
+    bool stopping;
+    
+    void workerLoop(uint32_t index);
+
+public:
+    explicit ThreadPool(uint32_t num_threads);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    uint32_t size() const { return static_cast<uint32_t>(threads.size()) + 1; }
+    void run(uint32_t active, const std::function<void(uint32_t)>& fn);
+};
@@ -20,16 +20,16 @@ read -p "Pick (1-3): " choice
 
 case $choice in
     1)
-        ./benchmark ./ant_mania ../task/hiveum_map_small.txt 50 100 200
+        ./benchmark --repetitions 20 ../task/hiveum_map_small.txt 50 100 200
         ;;
     2)
-        ./benchmark ./ant_mania ../task/hiveum_map_medium.txt 100 500 1000
+        ./benchmark --repetitions 20 ../task/hiveum_map_medium.txt 100 500 1000
         ;;
     3)
-        ./benchmark ./ant_mania
+        ./benchmark
         ;;
     *)
-        ./benchmark ./ant_mania
+        ./benchmark
         ;;
 esac
 
@@ -1,7 +1,42 @@
 #include "ant_mania.h"
 
+#include <cstring>
+
+// Lookup tables over a colony's 4-bit live-neighbor mask
+struct DirectionTables {
+    uint8_t count[16];      // Number of live directions
+    uint8_t nth[16][4];     // nth[mask][k] = k-th live direction, in north/south/east/west order
+};
+
+static constexpr DirectionTables makeDirectionTables() {
+    DirectionTables tables{};
+    for (uint8_t mask = 0; mask < 16; ++mask) {
+        uint8_t count = 0;
+        for (uint8_t dir = 0; dir < 4; ++dir) {
+            if (mask & (1u << dir)) tables.nth[mask][count++] = dir;
+        }
+        tables.count[mask] = count;
+    }
+    return tables;
+}
+
+static constexpr DirectionTables DIRECTION_TABLES = makeDirectionTables();
+
+// 64-bit seed from the OS entropy source, used unless setSeed() is called
+static uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
 AntManiaSimulation::AntManiaSimulation() 
-    : rng(std::random_device{}())
+    : ants(&memory)
+    , live_masks(ArenaAllocator<uint8_t>(&memory))
+    , destroyed_bits(ArenaAllocator<uint64_t>(&memory))
+    , rng_kind(RngKind::XOSHIRO)
+    , seed(randomSeed())
+    , fast_rng(seed)
+    , random_batch(ArenaAllocator<uint32_t>(&memory))
+    , rng(seed)
     , direction_dist(0, 3)  // 0-3 for directions
     , count_dists{std::uniform_int_distribution<uint8_t>(0, 0),  // 1 direction
                   std::uniform_int_distribution<uint8_t>(0, 1),  // 2 directions
@@ -10,105 +45,140 @@ AntManiaSimulation::AntManiaSimulation()
     , total_ants(0)
     , colonies_destroyed(0)
     , total_fight_pairs(0)
+    , iterations(0)
+    , total_ant_steps(0)
     , alive_ants_count(0)
-    , max_moves_ants_count(0) {}
+    , max_moves_ants_count(0)
+    , occupancy(ArenaAllocator<ColonyOccupancy>(&memory))
+    , next_occupant(ArenaAllocator<uint32_t>(&memory))
+    , occupancy_generation(0)
+    , record_trapped(false)
+    , run_state(RunState::IDLE)
+    , run_time(0)
+    , run_engine(SimulationEngine::TWO_PASS)
+    , run_rng(RngKind::XOSHIRO)
+    , run_threads(1)
+    , engine(SimulationEngine::TWO_PASS)
+    , num_threads(std::max(1u, std::thread::hardware_concurrency()))
+    , fast_forward(true)
+    , fast_forward_interval(FAST_FORWARD_MIN_INTERVAL)
+    , fast_forward_countdown(FAST_FORWARD_MIN_INTERVAL)
+    , last_check_destroyed(UINT32_MAX)
+    , last_check_alive(UINT32_MAX)
+    , component_of(ArenaAllocator<uint32_t>(&memory))
+    , bfs_queue(ArenaAllocator<uint32_t>(&memory))
+    , output(std::cout)
+    , silent(false)
+    , colony_order(ColonyOrder::FILE)
+    , loader_threads(1)
+    , vector_moves(moveKernelAvailable())
+    , specialized(true)
+    , advance_step(&AntManiaSimulation::advanceGeneric)
+    , checkpoint_interval(0)
+    , resume_pending(false) {}
+
+void AntManiaSimulation::setSeed(uint64_t new_seed) {
+    seed = new_seed;
+    fast_rng.reseed(seed);
+    rng.seed(seed);
+}
 
 bool AntManiaSimulation::loadMap(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return false;
-    }
+    auto loaded = std::make_shared<ColonyGraph>();
+    loaded->setMemoryOptions(memory.getOptions());
+    if (!loaded->load(filename, loader_threads)) return false;
+    loaded->reorder(colony_order);
     
-    // First pass: count colonies and reserve memory
-    std::string line;
-    size_t colony_count = 0;
-    while (std::getline(file, line)) {
-        if (!line.empty()) colony_count++;
+    setGraph(std::move(loaded));
+    if (!silent) {
+        std::cout << "Loaded " << colonyCount() << " colonies from " << filename << std::endl;
     }
+    return true;
+}
+
+bool AntManiaSimulation::compileMap(const std::string& filename) const {
+    return graph && graph->compile(filename);
+}
+
+void AntManiaSimulation::setGraph(std::shared_ptr<const ColonyGraph> shared_graph) {
+    graph = std::move(shared_graph);
+    reset();
+}
+
+void AntManiaSimulation::reset() {
+    // Per-colony state in one arena block; later resets of the same map reuse it as is
+    const uint32_t colony_count = colonyCount();
+    const uint32_t padded_count = (colony_count + 3) & ~3u;  // The vector kernel gathers masks 4 bytes at a time
+    const uint32_t bitmap_words = (colony_count + 63) / 64;
+    memory.reserve(arenaGrowth(live_masks, padded_count) + arenaGrowth(destroyed_bits, bitmap_words) +
+                   arenaGrowth(occupancy, colony_count) + arenaGrowth(component_of, colony_count) +
+                   arenaGrowth(bfs_queue, colony_count));
+    live_masks.reserve(padded_count);
+    destroyed_bits.reserve(bitmap_words);
+    occupancy.reserve(colony_count);
+    component_of.reserve(colony_count);
+    bfs_queue.reserve(colony_count);
     
-    // Reserve memory to avoid reallocations during simulation
-    colonies.reserve(colony_count);
-    colony_names.reserve(colony_count);
-    name_to_id.reserve(colony_count);
-    
-    // Second pass: parse colony names first
-    file.clear();
-    file.seekg(0);
-    
-    uint32_t colony_id = 0;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        
-        // Parse colony name
-        size_t space_pos = line.find(' ');
-        std::string colony_name = line.substr(0, space_pos);
-        
-        // Store mapping
-        colony_names.push_back(colony_name);
-        name_to_id[colony_name] = colony_id;
-        colony_id++;
+    // One byte per colony plus a bitmap; assignment reuses this run's storage
+    if (graph) {
+        live_masks = graph->initialLiveMasks();
+    } else {
+        live_masks.clear();
     }
+    live_masks.resize(padded_count, 0);
+    destroyed_bits.assign(bitmap_words, 0);
     
-    // Third pass: parse connections with resolved IDs
-    file.clear();
-    file.seekg(0);
-    
-    colony_id = 0;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        
-        // Initialize colony with no connections
-        Colony colony;
-        colony.destroyed = false;
-        colony.connections.fill(NO_CONNECTION);
-        
-        // Parse connections
-        size_t space_pos = line.find(' ');
-        std::istringstream iss(line.substr(space_pos + 1));
-        std::string connection;
-        
-        while (iss >> connection) {
-            size_t eq_pos = connection.find('=');
-            if (eq_pos != std::string::npos) {
-                std::string direction = connection.substr(0, eq_pos);
-                std::string target = connection.substr(eq_pos + 1);
-                
-                // Convert direction to integer using constexpr helper
-                Direction dir = direction_to_enum(direction);
-                // Skip invalid directions explicitly
-                if (dir != Direction::INVALID) {
-                    // Now we can safely resolve the target ID
-                    auto it = name_to_id.find(target);
-                    if (it != name_to_id.end()) {
-                        colony.connections[static_cast<uint8_t>(dir)] = it->second;
-                    }
-                }
-            }
-        }
-        
-        colonies.push_back(colony);
-        colony_id++;
+    // Generation stamps make stale slots invisible, so same-size slots are simply kept
+    if (occupancy.size() != colony_count) {
+        occupancy.assign(colony_count, ColonyOccupancy{0, 0, NO_ANT, {NO_ANT, NO_ANT}});
+        occupancy_generation = 0;
     }
     
-    // Initialize reusable buffers
-    colony_ant_counts.resize(colony_count, 0);
-    colony_ant_ids.resize(colony_count, {UINT32_MAX, UINT32_MAX});
+    ants.clear();
+    run_state = RunState::IDLE;
+    total_ants = 0;
+    colonies_destroyed = 0;
+    total_fight_pairs = 0;
+    iterations = 0;
+    total_ant_steps = 0;
+    alive_ants_count = 0;
+    max_moves_ants_count = 0;
+    output.resetMessageCount();
+}
+
+void AntManiaSimulation::setSilent(bool enabled) {
+    silent = enabled;
+    output.setQuiet(enabled);
+}
+
+void AntManiaSimulation::destroyColony(uint32_t colony_id) {
+    destroyed_bits[colony_id >> 6] |= uint64_t{1} << (colony_id & 63);
+    colonies_destroyed++;
     
-    std::cout << "Loaded " << colony_count << " colonies from " << filename << std::endl;
-    return true;
+    clearLiveMasks(colony_id);
+}
+
+void AntManiaSimulation::clearLiveMasks(uint32_t colony_id) {
+    // Nothing leaves a destroyed colony, and every tunnel into it disappears from its source's live mask
+    live_masks[colony_id] = 0;
+    for (const uint32_t* e = graph->incomingBegin(colony_id); e != graph->incomingEnd(colony_id); ++e) {
+        uint32_t edge = *e;
+        live_masks[edge >> 2] &= static_cast<uint8_t>(~(1u << (edge & 3)));
+    }
 }
 
 void AntManiaSimulation::createAnts(uint32_t num_ants) {
     total_ants = num_ants;
     alive_ants_count = num_ants;
     max_moves_ants_count = 0;
-    ants.reserve(num_ants);
+    ants.clear();
+    reserveAntMemory(num_ants);
     
-    // Get available colonies (non-destroyed)
+    // Get available colonies (non-destroyed), in file order so placement ignores reordering
     std::vector<uint32_t> available_colonies;
-    for (uint32_t i = 0; i < colonies.size(); ++i) {
-        if (!colonies[i].destroyed) {
+    for (uint32_t k = 0; k < colonyCount(); ++k) {
+        uint32_t i = graph->colonyAtFileIndex(k);
+        if (!destroyed(i)) {
             available_colonies.push_back(i);
         }
     }
@@ -122,71 +192,395 @@ void AntManiaSimulation::createAnts(uint32_t num_ants) {
     std::uniform_int_distribution<uint32_t> colony_dist(0, available_colonies.size() - 1);
     
     for (uint32_t i = 0; i < num_ants; ++i) {
-        Ant ant;
-        ant.colony_id = available_colonies[colony_dist(rng)];
-        ant.move_count = 0;
-        ant.alive = true;
-        ant.ant_id = i;  // Assign unique ID
-        ants.push_back(ant);
+        uint32_t pick = rng_kind == RngKind::MT19937 ? colony_dist(rng) : colony_dist(fast_rng);
+        ants.add(available_colonies[pick], i);  // Assign unique ID
     }
     
-    std::cout << "Created " << num_ants << " ants" << std::endl;
+    sizeIterationBuffers();
+    
+    // A checkpoint taken before the first iteration starts the same schedule as runSimulation()
+    fast_forward_interval = FAST_FORWARD_MIN_INTERVAL;
+    fast_forward_countdown = FAST_FORWARD_MIN_INTERVAL;
+    last_check_destroyed = UINT32_MAX;
+    last_check_alive = UINT32_MAX;
+    resume_pending = false;
+    run_state = RunState::IDLE;
+    
+    if (!silent) {
+        std::cout << "Created " << num_ants << " ants (seed " << seed << ")" << std::endl;
+    }
+}
+
+void AntManiaSimulation::reserveAntMemory(size_t ant_count) {
+    // The ant arrays and the per-ant iteration buffers share one arena block
+    memory.reserve(ants.growthBytes(ant_count) + arenaGrowth(next_occupant, ant_count) +
+                   arenaGrowth(random_batch, ant_count));
+    ants.reserve(ant_count);
+    next_occupant.reserve(ant_count);
+    random_batch.reserve(ant_count);
+}
+
+void AntManiaSimulation::sizeIterationBuffers() {
+    // Collision buffers sized for the worst case so the hot path never reallocates
+    next_occupant.resize(ants.size(), NO_ANT);
+    random_batch.resize(ants.size());
+    touched_colonies.reserve(std::min<size_t>(ants.size(), colonyCount()));
+    destroyed_this_iteration.reserve(std::min<size_t>(ants.size(), colonyCount()));
 }
 
 void AntManiaSimulation::runSimulation() {
-    std::cout << "Starting simulation..." << std::endl;
-    auto start_time = std::chrono::high_resolution_clock::now();
+    announceRun();
+    ConsoleObserver console(output, silent);
+    run(console);
+}
+
+StepResult AntManiaSimulation::step(uint32_t max_iterations) {
+    announceRun();
+    ConsoleObserver console(output, silent);
+    return step(console, max_iterations);
+}
+
+StepResult AntManiaSimulation::runFor(std::chrono::nanoseconds budget) {
+    announceRun();
+    ConsoleObserver console(output, silent);
+    return runFor(console, budget);
+}
+
+void AntManiaSimulation::announceRun() const {
+    if (!silent && run_state == RunState::IDLE) std::cout << "Starting simulation..." << std::endl;
+}
+
+void AntManiaSimulation::beginRun(bool trapped_events) {
+    run_state = RunState::RUNNING;
+    run_time = std::chrono::high_resolution_clock::duration::zero();
+    run_engine = engine;
+    run_rng = rng_kind;
+    run_threads = num_threads;
+    
+    if (run_engine == SimulationEngine::PARALLEL && (!pool || pool->size() != run_threads)) {
+        pool = std::make_unique<ThreadPool>(run_threads);
+        scratch = std::vector<WorkerScratch>(run_threads);
+        for (auto& worker : scratch) {
+            worker.buckets.resize(run_threads);
+        }
+    }
     
-    uint32_t iteration = 0;
+    record_trapped = trapped_events;
+    trapped_this_iteration.clear();
+    if (record_trapped) trapped_this_iteration.reserve(ants.size());
+    advance_step = selectAdvance();
     
-    while (true) {
-        iteration++;
-        
-        // Early termination check - now O(1) instead of O(n)
-        if (alive_ants_count == 0 || alive_ants_count == max_moves_ants_count) {
+    if (resume_pending) {
+        // Counters and the fast-forward schedule come from the restored checkpoint
+        resume_pending = false;
+    } else {
+        fast_forward_interval = FAST_FORWARD_MIN_INTERVAL;
+        fast_forward_countdown = FAST_FORWARD_MIN_INTERVAL;
+        last_check_destroyed = UINT32_MAX;
+        last_check_alive = UINT32_MAX;
+        total_ant_steps = 0;
+        iterations = 0;
+    }
+    
+    ANT_INSTRUMENT(instrumentation.start();)
+}
+
+AntManiaSimulation::AdvanceFn AntManiaSimulation::selectAdvance() const {
+    // Specialized instantiations cover the default features; anything else, and
+    // mt19937 runs, take the generic path
+    const bool kernel = vector_moves && colonyCount() < MOVE_KERNEL_MAX_COLONIES;
+    const bool mt19937 = run_rng == RngKind::MT19937 && run_engine != SimulationEngine::PARALLEL;
+    if (!graph || colonyCount() == 0 || !specialized || !kernel || !fast_forward || record_trapped || mt19937) {
+        return &AntManiaSimulation::advanceGeneric;
+    }
+    
+    using Self = AntManiaSimulation;
+    const bool narrow = graph->hasNarrowIds();
+    const bool counter = run_rng == RngKind::COUNTER;
+    switch (run_engine) {
+        case SimulationEngine::PARALLEL:
+            return narrow ? &Self::advanceWith<SpecializedPolicy<SimulationEngine::PARALLEL, RngKind::COUNTER, uint16_t>>
+                          : &Self::advanceWith<SpecializedPolicy<SimulationEngine::PARALLEL, RngKind::COUNTER, uint32_t>>;
+        case SimulationEngine::FUSED:
+            if (counter) {
+                return narrow ? &Self::advanceWith<SpecializedPolicy<SimulationEngine::FUSED, RngKind::COUNTER, uint16_t>>
+                              : &Self::advanceWith<SpecializedPolicy<SimulationEngine::FUSED, RngKind::COUNTER, uint32_t>>;
+            }
+            return narrow ? &Self::advanceWith<SpecializedPolicy<SimulationEngine::FUSED, RngKind::XOSHIRO, uint16_t>>
+                          : &Self::advanceWith<SpecializedPolicy<SimulationEngine::FUSED, RngKind::XOSHIRO, uint32_t>>;
+        case SimulationEngine::TWO_PASS:
             break;
-        }
-        
-        // Move all ants
-        moveAnts();
-        
-        // Check for collisions
-        checkCollisions();
-        
-        // Progress reporting (less frequent for performance)
-        if (iteration % 10000 == 0) {
-            std::cout << "Iteration " << iteration << ": " << alive_ants_count << " ants alive, " 
-                     << colonies_destroyed << " colonies destroyed" << std::endl;
+    }
+    if (counter) {
+        return narrow ? &Self::advanceWith<SpecializedPolicy<SimulationEngine::TWO_PASS, RngKind::COUNTER, uint16_t>>
+                      : &Self::advanceWith<SpecializedPolicy<SimulationEngine::TWO_PASS, RngKind::COUNTER, uint32_t>>;
+    }
+    return narrow ? &Self::advanceWith<SpecializedPolicy<SimulationEngine::TWO_PASS, RngKind::XOSHIRO, uint16_t>>
+                  : &Self::advanceWith<SpecializedPolicy<SimulationEngine::TWO_PASS, RngKind::XOSHIRO, uint32_t>>;
+}
+
+bool AntManiaSimulation::advanceGeneric() {
+    // Dispatches on the run's settings every iteration; with no map, the first check terminates
+    const bool narrow = graph && graph->hasNarrowIds();
+    switch (run_engine) {
+        case SimulationEngine::PARALLEL:
+            return narrow ? advanceWith<GenericPolicy<SimulationEngine::PARALLEL, RngKind::COUNTER, uint16_t>>()
+                          : advanceWith<GenericPolicy<SimulationEngine::PARALLEL, RngKind::COUNTER, uint32_t>>();
+        case SimulationEngine::FUSED:
+            return narrow ? advanceGenericFor<SimulationEngine::FUSED, uint16_t>()
+                          : advanceGenericFor<SimulationEngine::FUSED, uint32_t>();
+        case SimulationEngine::TWO_PASS:
+            break;
+    }
+    return narrow ? advanceGenericFor<SimulationEngine::TWO_PASS, uint16_t>()
+                  : advanceGenericFor<SimulationEngine::TWO_PASS, uint32_t>();
+}
+
+template <SimulationEngine ENGINE, typename ColonyId>
+bool AntManiaSimulation::advanceGenericFor() {
+    if (run_rng == RngKind::XOSHIRO) {
+        return advanceWith<GenericPolicy<ENGINE, RngKind::XOSHIRO, ColonyId>>();
+    } else if (run_rng == RngKind::MT19937) {
+        return advanceWith<GenericPolicy<ENGINE, RngKind::MT19937, ColonyId>>();
+    }
+    return advanceWith<GenericPolicy<ENGINE, RngKind::COUNTER, ColonyId>>();
+}
+
+template <typename Policy>
+bool AntManiaSimulation::advanceWith() {
+    // The iteration that detects termination is counted too, as it always has been
+    iterations++;
+    
+    // Early termination check - now O(1) instead of O(n)
+    if (alive_ants_count == 0 || alive_ants_count == max_moves_ants_count) {
+        return false;
+    }
+    
+    ANT_INSTRUMENT(instrumentation.beginIteration(iterations, alive_ants_count, total_ant_steps, colonies_destroyed);)
+    
+    if (enabled(Policy::trapped_events, record_trapped)) trapped_this_iteration.clear();
+    
+    if constexpr (Policy::engine == SimulationEngine::PARALLEL) {
+        runParallelIteration<Policy>();
+    } else {
+        runIteration<Policy>();
+    }
+    
+    ANT_INSTRUMENT(instrumentation.enterPhase(Phase::MAINTENANCE);)
+    
+    // Periodically retire ants that can no longer meet another ant
+    if (enabled(Policy::fast_forward, fast_forward) && --fast_forward_countdown == 0) {
+        checkIsolatedAnts();
+        fast_forward_countdown = fast_forward_interval;
+    }
+    
+    // Drop dead ants so later iterations only touch survivors
+    if (ants.dead_count > ants.size() * COMPACTION_DEAD_FRACTION) {
+        ants.compact();
+    }
+    return true;
+}
+
+void AntManiaSimulation::beginSlice(bool trapped_events) {
+    slice_start = std::chrono::high_resolution_clock::now();
+    if (run_state == RunState::IDLE) {
+        beginRun(trapped_events);
+    } else if (trapped_events != record_trapped) {
+        // A new observer between steps: start or stop recording trapped ants
+        record_trapped = trapped_events;
+        trapped_this_iteration.clear();
+        if (record_trapped) trapped_this_iteration.reserve(ants.size());
+        advance_step = selectAdvance();
+    }
+}
+
+StepResult AntManiaSimulation::endSlice(uint32_t steps) {
+    if (run_state == RunState::RUNNING) {
+        run_time += std::chrono::high_resolution_clock::now() - slice_start;
+    }
+    return {steps, iterations, alive_ants_count, colonies_destroyed, run_state == RunState::FINISHED};
+}
+
+void AntManiaSimulation::endIteration() {
+    // After the observer, so a checkpoint's message count includes this iteration
+    if (checkpoint_interval != 0 && iterations % checkpoint_interval == 0) {
+        takeCheckpoint(iterations);
+    }
+    
+    ANT_INSTRUMENT(instrumentation.endIteration(total_ant_steps, colonies_destroyed);)
+}
+
+RunEndEvent AntManiaSimulation::finishRun() {
+    ANT_INSTRUMENT(instrumentation.stop();)
+    run_state = RunState::FINISHED;
+    
+    if (checkpoint_writer && !checkpoint_writer->wait()) {
+        std::cerr << "Error: Could not write checkpoint " << checkpoint_path << std::endl;
+    }
+    
+    // The run's time includes writing out its buffered output
+    output.flush();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        run_time + (std::chrono::high_resolution_clock::now() - slice_start));
+    return {iterations, alive_ants_count, colonies_destroyed, total_fight_pairs, total_ant_steps,
+            static_cast<uint64_t>(duration.count())};
+}
+
+void AntManiaSimulation::captureSnapshot(SimulationSnapshot& snapshot, uint32_t completed_iterations) const {
+    snapshot.colony_count = colonyCount();
+    snapshot.edge_count = graph ? graph->edgeCount() : 0;
+    snapshot.colony_order = static_cast<uint8_t>(colony_order);
+    // Mid-run, the settings the run is actually using
+    const bool running = run_state == RunState::RUNNING;
+    const RngKind kind = running ? run_rng : rng_kind;
+    snapshot.rng_kind = static_cast<uint8_t>(kind);
+    snapshot.engine = static_cast<uint8_t>(running ? run_engine : engine);
+    snapshot.fast_forward = fast_forward;
+    
+    snapshot.seed = seed;
+    snapshot.xoshiro_state = fast_rng.state();
+    snapshot.mt_state.clear();
+    if (kind == RngKind::MT19937) {
+        // The only portable way to read the state; other generators skip it
+        std::ostringstream state;
+        state << rng;
+        snapshot.mt_state = state.str();
+    }
+    
+    snapshot.iterations = completed_iterations;
+    snapshot.total_ants = total_ants;
+    snapshot.colonies_destroyed = colonies_destroyed;
+    snapshot.total_fight_pairs = total_fight_pairs;
+    snapshot.alive_ants_count = alive_ants_count;
+    snapshot.max_moves_ants_count = max_moves_ants_count;
+    snapshot.dead_count = ants.dead_count;
+    snapshot.total_ant_steps = total_ant_steps;
+    snapshot.message_count = output.getMessageCount();
+    
+    snapshot.fast_forward_interval = fast_forward_interval;
+    snapshot.fast_forward_countdown = fast_forward_countdown;
+    snapshot.last_check_destroyed = last_check_destroyed;
+    snapshot.last_check_alive = last_check_alive;
+    
+    // Dead slots are kept: xoshiro draws one value per slot, so the layout is part of the state
+    snapshot.colony_ids.assign(ants.colony_ids.begin(), ants.colony_ids.end());
+    snapshot.move_counts.assign(ants.move_counts.begin(), ants.move_counts.end());
+    snapshot.ant_ids.assign(ants.ant_ids.begin(), ants.ant_ids.end());
+    snapshot.destroyed_bits.assign(destroyed_bits.begin(), destroyed_bits.end());
+}
+
+void AntManiaSimulation::takeCheckpoint(uint32_t completed_iterations) {
+    // Output up to this iteration reaches the stream first, so a resumed run continues it
+    output.flush();
+    
+    // The copy is the only stall; serializing and writing happen on the writer thread
+    captureSnapshot(checkpoint_buffer, completed_iterations);
+    if (!checkpoint_writer) checkpoint_writer = std::make_unique<CheckpointWriter>();
+    checkpoint_writer->submit(checkpoint_buffer, checkpoint_path);
+}
+
+bool AntManiaSimulation::saveCheckpoint(const std::string& path) const {
+    SimulationSnapshot snapshot;
+    captureSnapshot(snapshot, iterations);
+    return writeCheckpoint(path, snapshot);
+}
+
+bool AntManiaSimulation::restoreCheckpoint(const std::string& path) {
+    SimulationSnapshot snapshot;
+    std::string error;
+    if (!graph) {
+        error = "no map loaded";
+    } else if (readCheckpoint(path, snapshot, error)) {
+        if (applySnapshot(snapshot, error)) return true;
+    }
+    std::cerr << "Error: " << path << ": " << error << std::endl;
+    return false;
+}
+
+bool AntManiaSimulation::applySnapshot(const SimulationSnapshot& snapshot, std::string& error) {
+    if (snapshot.colony_count != colonyCount() || snapshot.edge_count != graph->edgeCount()) {
+        error = "checkpoint was taken on a different map";
+        return false;
+    }
+    if (snapshot.colony_order != static_cast<uint8_t>(colony_order)) {
+        error = "checkpoint was taken with a different colony order";
+        return false;
+    }
+    if (snapshot.rng_kind > static_cast<uint8_t>(RngKind::COUNTER) ||
+        snapshot.engine > static_cast<uint8_t>(SimulationEngine::PARALLEL)) {
+        error = "checkpoint has an unknown RNG or engine";
+        return false;
+    }
+    
+    std::mt19937_64 restored_rng(snapshot.seed);
+    if (!snapshot.mt_state.empty()) {
+        std::istringstream state(snapshot.mt_state);
+        state >> restored_rng;
+        if (!state) {
+            error = "checkpoint has a corrupt mt19937 state";
+            return false;
         }
     }
     
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    rng_kind = static_cast<RngKind>(snapshot.rng_kind);
+    engine = static_cast<SimulationEngine>(snapshot.engine);
+    fast_forward = snapshot.fast_forward != 0;
+    setSeed(snapshot.seed);
+    fast_rng.setState(snapshot.xoshiro_state);
+    rng = restored_rng;
     
-    std::cout << "\nSimulation completed in " << duration.count() << " microseconds" << std::endl;
-    std::cout << "Total iterations: " << iteration << std::endl;
-    std::cout << "Total fight pairs: " << total_fight_pairs << std::endl;
-    std::cout << "Colonies destroyed: " << colonies_destroyed << std::endl;
-    std::cout << "Ants remaining: " << alive_ants_count << std::endl;
+    // Live masks follow from the graph and the destroyed colonies
+    reset();
+    destroyed_bits.assign(snapshot.destroyed_bits.begin(), snapshot.destroyed_bits.end());
+    for (uint32_t c = 0; c < colonyCount(); ++c) {
+        if (destroyed(c)) clearLiveMasks(c);
+    }
+    
+    reserveAntMemory(snapshot.colony_ids.size());
+    ants.colony_ids.assign(snapshot.colony_ids.begin(), snapshot.colony_ids.end());
+    ants.move_counts.assign(snapshot.move_counts.begin(), snapshot.move_counts.end());
+    ants.ant_ids.assign(snapshot.ant_ids.begin(), snapshot.ant_ids.end());
+    ants.dead_count = snapshot.dead_count;
+    sizeIterationBuffers();
+    
+    iterations = snapshot.iterations;
+    total_ants = snapshot.total_ants;
+    colonies_destroyed = snapshot.colonies_destroyed;
+    total_fight_pairs = snapshot.total_fight_pairs;
+    alive_ants_count = snapshot.alive_ants_count;
+    max_moves_ants_count = snapshot.max_moves_ants_count;
+    total_ant_steps = snapshot.total_ant_steps;
+    output.setMessageCount(snapshot.message_count);
+    
+    fast_forward_interval = snapshot.fast_forward_interval;
+    fast_forward_countdown = snapshot.fast_forward_countdown;
+    last_check_destroyed = snapshot.last_check_destroyed;
+    last_check_alive = snapshot.last_check_alive;
+    resume_pending = true;
+    return true;
 }
 
 void AntManiaSimulation::printRemainingWorld() {
-    std::cout << "\nRemaining world map:" << std::endl;
+    output.write("\nRemaining world map:\n");
     
-    for (uint32_t i = 0; i < colonies.size(); ++i) {
-        if (!colonies[i].destroyed) {
-            std::cout << colony_names[i];
+    for (uint32_t k = 0; k < colonyCount(); ++k) {
+        uint32_t i = graph->colonyAtFileIndex(k);
+        if (!destroyed(i)) {
+            output.write(colonyName(i));
             
             // Print valid connections
             for (uint8_t dir = 0; dir < 4; ++dir) {
-                if (colonies[i].connections[dir] != NO_CONNECTION && 
-                    !colonies[colonies[i].connections[dir]].destroyed) {
-                    std::cout << " " << enum_to_direction(static_cast<Direction>(dir)) << "=" << colony_names[colonies[i].connections[dir]];
+                uint32_t target = graph->connection(i, dir);
+                if (target != NO_CONNECTION && !destroyed(target)) {
+                    output.write(' ').write(ColonyGraph::enum_to_direction(static_cast<Direction>(dir))).write('=')
+                          .write(colonyName(target));
                 }
             }
-            std::cout << std::endl;
+            output.write('\n');
         }
     }
+    output.flush();
 }
 
 void AntManiaSimulation::printStatistics() {
@@ -196,133 +590,516 @@ void AntManiaSimulation::printStatistics() {
     std::cout << "Total fight pairs: " << total_fight_pairs << std::endl;
     std::cout << "Ants remaining: " << alive_ants_count << std::endl;
     
-    uint32_t remaining_colonies = 0;
-    for (const auto& colony : colonies) {
-        if (!colony.destroyed) {
-            remaining_colonies++;
-        }
+    std::cout << "Colonies remaining: " << colonyCount() - colonies_destroyed << std::endl;
+}
+
+template <typename Policy>
+void AntManiaSimulation::runIteration() {
+    ANT_INSTRUMENT(instrumentation.enterPhase(Phase::MOVE);)
+    
+    if constexpr (Policy::rng == RngKind::XOSHIRO) {
+        // Draw this iteration's random choices in one tight loop
+        fast_rng.fill32(random_batch.data(), ants.size());
     }
-    std::cout << "Colonies remaining: " << remaining_colonies << std::endl;
+    
+    if constexpr (Policy::engine == SimulationEngine::FUSED) {
+        // Move and count occupants in one pass over the ants
+        moveAndCollide<Policy>();
+    } else {
+        // Move all ants
+        moveAnts<Policy>();
+        
+        // Check for collisions
+        ANT_INSTRUMENT(instrumentation.enterPhase(Phase::COLLIDE);)
+        checkCollisions();
+    }
+}
+
+inline void AntManiaSimulation::recordTrapped(uint32_t ant_index) {
+    trapped_this_iteration.push_back({ants.ant_ids[ant_index], ants.colony_ids[ant_index], ants.move_counts[ant_index]});
+}
+
+inline void AntManiaSimulation::killAnt(uint32_t ant_index) {
+    // Keep the max-moves counter consistent so termination still triggers
+    if (ants.move_counts[ant_index] >= MAX_MOVES) {
+        max_moves_ants_count--;
+    }
+    ants.kill(ant_index);
+    alive_ants_count--;
 }
 
-Direction AntManiaSimulation::direction_to_enum(const std::string& direction) {
-    switch (direction[0]) {
-        case 'n': return Direction::NORTH;
-        case 's': return Direction::SOUTH;
-        case 'e': return Direction::EAST;
-        case 'w': return Direction::WEST;
-        default: return Direction::INVALID;  // Explicitly mark invalid directions
+template <RngKind KIND, typename ColonyId>
+inline MoveResult AntManiaSimulation::stepAnt(uint32_t ant_index) {
+    const uint32_t colony_id = ants.colony_ids[ant_index];
+    
+    // Valid connections come straight from the maintained live mask, which is
+    // empty for a destroyed colony, so the destroyed bitmap is never read here
+    uint8_t mask = live_masks[colony_id];
+    uint8_t count = DIRECTION_TABLES.count[mask];
+    if (count == 0) {
+        return MoveResult::TRAPPED;
+    }
+    
+    // Move to random valid connection
+    uint8_t choice;
+    if constexpr (KIND == RngKind::XOSHIRO) {
+        choice = static_cast<uint8_t>(boundedDraw(random_batch[ant_index], count));
+    } else if constexpr (KIND == RngKind::COUNTER) {
+        uint32_t random = counterDraw(seed, ants.ant_ids[ant_index], ants.move_counts[ant_index]);
+        choice = static_cast<uint8_t>(boundedDraw(random, count));
+    } else {
+        choice = count_dists[count - 1](rng);
+    }
+    uint8_t random_dir = DIRECTION_TABLES.nth[mask][choice];
+    ants.colony_ids[ant_index] = graph->connectionTable<ColonyId>()[colony_id][random_dir];
+    
+    return ++ants.move_counts[ant_index] == MAX_MOVES ? MoveResult::REACHED_MAX : MoveResult::MOVED;
+}
+
+template <typename Policy>
+inline bool AntManiaSimulation::moveAnt(uint32_t ant_index) {
+    switch (stepAnt<Policy::rng, typename Policy::ColonyId>(ant_index)) {
+        case MoveResult::TRAPPED:
+            if (enabled(Policy::trapped_events, record_trapped)) recordTrapped(ant_index);
+            killAnt(ant_index);
+            return false;
+        case MoveResult::REACHED_MAX:
+            // Update max moves counter incrementally
+            max_moves_ants_count++;
+            break;
+        case MoveResult::MOVED:
+            break;
     }
+    total_ant_steps++;
+    return true;
 }
 
-constexpr const char* AntManiaSimulation::enum_to_direction(Direction dir) {
-    switch (dir) {
-        case Direction::NORTH: return "north";
-        case Direction::SOUTH: return "south";
-        case Direction::EAST: return "east";
-        case Direction::WEST: return "west";
-        case Direction::INVALID: return "invalid";
+template <typename Policy>
+inline bool AntManiaSimulation::useVectorMoves() const {
+    // Specialized policies only turn the kernel on once the CPU and map size allow it
+    return enabled(Policy::vector_moves, vector_moves && colonyCount() < MOVE_KERNEL_MAX_COLONIES);
+}
+
+template <typename Policy>
+inline uint32_t AntManiaSimulation::moveVectorized(uint32_t begin, uint32_t end) {
+    using ColonyId = typename Policy::ColonyId;
+    MoveBatch batch{ants.colony_ids.data(), ants.move_counts.data(), ants.ant_ids.data(), random_batch.data(),
+                    live_masks.data(), graph->connectionTable<ColonyId>(), seed, static_cast<uint16_t>(MAX_MOVES), nullptr};
+    MoveTally tally;
+    const size_t recorded = trapped_this_iteration.size();
+    if (enabled(Policy::trapped_events, record_trapped)) {
+        // Room for every ant in the range; trimmed to what the kernel wrote
+        trapped_this_iteration.resize(recorded + (end - begin));
+        batch.trapped = trapped_this_iteration.data() + recorded;
+    }
+    uint32_t done = moveAntsVectorized<Policy::rng, ColonyId>(batch, begin, end, tally);
+    if (enabled(Policy::trapped_events, record_trapped)) {
+        trapped_this_iteration.resize(recorded + tally.trapped);
     }
-    return "invalid";  // fallback
+    
+    // Same counter updates moveAnt() makes, summed over the range
+    ants.dead_count += tally.trapped;
+    alive_ants_count -= tally.trapped;
+    max_moves_ants_count += tally.reached_max - tally.trapped_at_max;
+    total_ant_steps += tally.moved;
+    return done;
 }
 
+template <typename Policy>
 void AntManiaSimulation::moveAnts() {
     // Process ants in batches for better cache performance
-    static constexpr size_t BATCH_SIZE = 8;
+    static constexpr uint32_t BATCH_SIZE = 8;
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    
+    // Whole batches of eight go through the vector kernel when available; the rest is scalar
+    uint32_t first = 0;
+    if constexpr (Policy::vector_moves != Toggle::OFF) {
+        if (useVectorMoves<Policy>()) first = moveVectorized<Policy>(0, ant_count);
+    }
     
-    for (size_t i = 0; i < ants.size(); i += BATCH_SIZE) {
-        size_t batch_size = std::min(BATCH_SIZE, ants.size() - i);
+    for (uint32_t i = first; i < ant_count; i += BATCH_SIZE) {
+        uint32_t batch_size = std::min(BATCH_SIZE, ant_count - i);
         
-        for (size_t j = 0; j < batch_size; ++j) {
-            Ant& ant = ants[i + j];
-            
+        for (uint32_t j = 0; j < batch_size; ++j) {
             // Skip dead ants
-            if (!ant.alive) continue;
-            
-            uint32_t current_colony = ant.colony_id;
+            if (!ants.alive(i + j)) continue;
             
-            // Check if colony is destroyed
-            if (colonies[current_colony].destroyed) {
-                ant.alive = false;
-                alive_ants_count--;
-                continue;
-            }
-            
-            // Find valid connections - using stack-allocated array
-            uint8_t valid_dirs[4];
-            uint8_t count = 0;
-            for (uint8_t dir = 0; dir < 4; ++dir) {
-                uint32_t target = colonies[current_colony].connections[dir];
-                if (target != NO_CONNECTION && !colonies[target].destroyed) {
-                    valid_dirs[count++] = dir;
+            moveAnt<Policy>(i + j);
+        }
+    }
+}
+
+template <typename Policy>
+void AntManiaSimulation::moveAndCollide() {
+    beginOccupancy();
+    
+    // Each surviving move claims its destination slot right away. Destruction
+    // waits until every ant has moved, so results match the two-pass engine.
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    uint32_t i = 0;
+    if constexpr (Policy::vector_moves != Toggle::OFF) {
+        // Vector moves for a chunk small enough to stay in L1, then its claims in ant order.
+        // Moves never read occupancy, so this matches claiming after each move; an ant
+        // still alive after its move has moved.
+        static constexpr uint32_t VECTOR_CHUNK = 256;
+        if (useVectorMoves<Policy>()) {
+            while (i + 8 <= ant_count) {
+                uint32_t end = moveVectorized<Policy>(i, std::min(i + VECTOR_CHUNK, ant_count));
+                for (; i < end; ++i) {
+                    if (ants.alive(i)) claimOccupancy(i, ants.colony_ids[i], touched_colonies);
                 }
             }
-            
-            if (count == 0) {
-                ant.alive = false;
-                alive_ants_count--;
-                continue;
-            }
-            
-            // Move to random valid connection
-            uint8_t random_dir = valid_dirs[count_dists[count - 1](rng)];
-            ant.colony_id = colonies[current_colony].connections[random_dir];
-            ant.move_count++;
-            
-            // Update max moves counter incrementally
-            if (ant.move_count == MAX_MOVES) {
-                max_moves_ants_count++;
-            }
         }
     }
+    for (; i < ant_count; ++i) {
+        if (ants.alive(i) && moveAnt<Policy>(i)) {
+            claimOccupancy(i, ants.colony_ids[i], touched_colonies);
+        }
+    }
+    
+    ANT_INSTRUMENT(instrumentation.enterPhase(Phase::COLLIDE);)
+    resolveCollisions();
 }
 
 void AntManiaSimulation::checkCollisions() {
-    // Clear reusable buffers
-    std::fill(colony_ant_counts.begin(), colony_ant_counts.end(), 0);
-    for (auto& ids : colony_ant_ids) {
-        ids[0] = UINT32_MAX;
-        ids[1] = UINT32_MAX;
-    }
-    
-    // Count ants per colony and collect first 2 ant IDs
-    for (const auto& ant : ants) {
-        if (ant.alive) {
-            uint32_t colony_id = ant.colony_id;
-            colony_ant_counts[colony_id]++;
-            
-            // Store first 2 IDs for reporting
-            if (colony_ant_ids[colony_id][0] == UINT32_MAX) {
-                colony_ant_ids[colony_id][0] = ant.ant_id;
-            } else if (colony_ant_ids[colony_id][1] == UINT32_MAX) {
-                colony_ant_ids[colony_id][1] = ant.ant_id;
-            }
+    beginOccupancy();
+    
+    // Count ants per colony, touching only occupied colonies
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    for (uint32_t i = 0; i < ant_count; ++i) {
+        if (ants.alive(i)) {
+            claimOccupancy(i, ants.colony_ids[i], touched_colonies);
         }
     }
     
+    resolveCollisions();
+}
+
+void AntManiaSimulation::beginOccupancy() {
+    touched_colonies.clear();
+    
+    // Bumping the generation invalidates every slot at once
+    if (++occupancy_generation == 0) {
+        for (auto& slot : occupancy) slot.stamp = 0;
+        occupancy_generation = 1;
+    }
+}
+
+void AntManiaSimulation::claimOccupancy(uint32_t ant_index, uint32_t colony_id, std::vector<uint32_t>& touched) {
+    ColonyOccupancy& slot = occupancy[colony_id];
+    
+    if (slot.stamp != occupancy_generation) {
+        slot.stamp = occupancy_generation;
+        slot.count = 0;
+        slot.head = NO_ANT;
+        slot.ant_ids = {NO_ANT, NO_ANT};
+        touched.push_back(colony_id);
+    }
+    
+    // Store first 2 IDs for reporting
+    if (slot.count < 2) {
+        slot.ant_ids[slot.count] = ants.ant_ids[ant_index];
+    }
+    slot.count++;
+    
+    next_occupant[ant_index] = slot.head;
+    slot.head = ant_index;
+}
+
+void AntManiaSimulation::resolveCollisions() {
+    ANT_INSTRUMENT(instrumentation.addTouched(touched_colonies.size());)
+    
     // Check for collisions (2+ ants in same colony)
-    for (uint32_t colony_id = 0; colony_id < colonies.size(); ++colony_id) {
-        if (colony_ant_counts[colony_id] >= 2 && !colonies[colony_id].destroyed) {
-            // Destroy colony
-            colonies[colony_id].destroyed = true;
-            colonies_destroyed++;
-            
-            // Count fight pairs - each pair of ants is a fight
-            uint32_t ants_in_colony = colony_ant_counts[colony_id];
-            total_fight_pairs += (ants_in_colony * (ants_in_colony - 1)) / 2;
+    destroyed_this_iteration.clear();
+    for (uint32_t colony_id : touched_colonies) {
+        if (occupancy[colony_id].count >= 2 && !destroyed(colony_id)) {
+            destroyed_this_iteration.push_back(colony_id);
+        }
+    }
+    
+    applyDestructions();
+}
+
+void AntManiaSimulation::applyDestructions() {
+    // Observers see destructions in file order, matching a full scan over colonies
+    if (graph->isReordered()) {
+        std::sort(destroyed_this_iteration.begin(), destroyed_this_iteration.end(),
+                  [this](uint32_t a, uint32_t b) { return graph->fileIndex(a) < graph->fileIndex(b); });
+    } else {
+        std::sort(destroyed_this_iteration.begin(), destroyed_this_iteration.end());
+    }
+    
+    for (uint32_t colony_id : destroyed_this_iteration) {
+        const ColonyOccupancy& slot = occupancy[colony_id];
+        
+        // Destroy colony
+        destroyColony(colony_id);
+        
+        // Count fight pairs - each pair of ants is a fight
+        total_fight_pairs += (slot.count * (slot.count - 1)) / 2;
+        
+        // Kill all ants in this colony via its occupant list
+        for (uint32_t i = slot.head; i != NO_ANT; i = next_occupant[i]) {
+            killAnt(i);
+        }
+    }
+}
+
+template <typename Policy>
+void AntManiaSimulation::runParallelIteration() {
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    const uint32_t workers = std::clamp(ant_count / MIN_ANTS_PER_WORKER, 1u, run_threads);
+    
+    // Counter-based draws make the outcome independent of partitioning,
+    // so small populations can simply run inline
+    ANT_INSTRUMENT(instrumentation.enterPhase(Phase::MOVE);)
+    if (workers == 1) {
+        moveAndCollide<Policy>();
+        return;
+    }
+    
+    beginOccupancy();
+    
+    // Phase 1: each worker moves a contiguous ant range and buckets the survivors
+    pool->run(workers, [this, workers](uint32_t w) { parallelMove<Policy>(w, workers); });
+    
+    // Phase 2: each partition counts occupants of the colonies it owns
+    ANT_INSTRUMENT(instrumentation.enterPhase(Phase::COLLIDE);)
+    pool->run(workers, [this, workers](uint32_t p) { parallelClaim(p, workers); });
+    
+    // Merge per-worker results; destruction itself is sequential and cheap
+    destroyed_this_iteration.clear();
+    for (uint32_t w = 0; w < workers; ++w) {
+        WorkerScratch& worker = scratch[w];
+        alive_ants_count -= worker.trapped;
+        max_moves_ants_count += worker.reached_max;
+        max_moves_ants_count -= worker.trapped_at_max;
+        ants.dead_count += worker.trapped;
+        total_ant_steps += worker.moved;
+        ANT_INSTRUMENT(instrumentation.addTouched(worker.touched.size());)
+        destroyed_this_iteration.insert(destroyed_this_iteration.end(), worker.destroyed.begin(), worker.destroyed.end());
+        if (enabled(Policy::trapped_events, record_trapped)) {
+            trapped_this_iteration.insert(trapped_this_iteration.end(), worker.trapped_ants.begin(), worker.trapped_ants.end());
+        }
+    }
+    
+    applyDestructions();
+}
+
+template <typename Policy>
+void AntManiaSimulation::parallelMove(uint32_t worker, uint32_t workers) {
+    WorkerScratch& local = scratch[worker];
+    local.trapped = 0;
+    local.trapped_at_max = 0;
+    local.reached_max = 0;
+    local.moved = 0;
+    local.trapped_ants.clear();
+    for (uint32_t p = 0; p < workers; ++p) {
+        local.buckets[p].clear();
+    }
+    
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    const uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(ant_count) * worker / workers);
+    const uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(ant_count) * (worker + 1) / workers);
+    
+    for (uint32_t i = begin; i < end; ++i) {
+        if (!ants.alive(i)) continue;
+        
+        switch (stepAnt<RngKind::COUNTER, typename Policy::ColonyId>(i)) {
+            case MoveResult::TRAPPED:
+                // Counters are merged after the phase; only this ant's slot is written here
+                if (ants.move_counts[i] >= MAX_MOVES) local.trapped_at_max++;
+                if (enabled(Policy::trapped_events, record_trapped)) local.trapped_ants.push_back({ants.ant_ids[i], ants.colony_ids[i], ants.move_counts[i]});
+                ants.colony_ids[i] = AntStore::DEAD_ANT;
+                local.trapped++;
+                continue;
+            case MoveResult::REACHED_MAX:
+                local.reached_max++;
+                break;
+            case MoveResult::MOVED:
+                break;
+        }
+        local.moved++;
+        
+        uint32_t colony_id = ants.colony_ids[i];
+        local.buckets[colony_id % workers].push_back({colony_id, i});
+    }
+}
+
+void AntManiaSimulation::parallelClaim(uint32_t partition, uint32_t workers) {
+    WorkerScratch& local = scratch[partition];
+    local.touched.clear();
+    local.destroyed.clear();
+    
+    // Draining workers in order visits ants in ascending index order, so the
+    // first two occupants recorded match the sequential engines
+    for (uint32_t w = 0; w < workers; ++w) {
+        for (const OccupantClaim& claim : scratch[w].buckets[partition]) {
+            claimOccupancy(claim.ant_index, claim.colony_id, local.touched);
+        }
+    }
+    
+    for (uint32_t colony_id : local.touched) {
+        if (occupancy[colony_id].count >= 2 && !destroyed(colony_id)) {
+            local.destroyed.push_back(colony_id);
+        }
+    }
+}
+
+void AntManiaSimulation::checkIsolatedAnts() {
+    // Component ant counts only change when an ant dies, so skip the rebuild otherwise
+    if (colonies_destroyed == last_check_destroyed && alive_ants_count == last_check_alive) {
+        return;
+    }
+    
+    labelComponents();
+    
+    uint32_t retired;
+    const bool narrow = graph->hasNarrowIds();
+    if (run_engine == SimulationEngine::PARALLEL || run_rng == RngKind::COUNTER) {
+        retired = narrow ? fastForwardIsolatedAnts<RngKind::COUNTER, uint16_t>()
+                         : fastForwardIsolatedAnts<RngKind::COUNTER, uint32_t>();
+    } else if (run_rng == RngKind::XOSHIRO) {
+        retired = narrow ? fastForwardIsolatedAnts<RngKind::XOSHIRO, uint16_t>()
+                         : fastForwardIsolatedAnts<RngKind::XOSHIRO, uint32_t>();
+    } else {
+        retired = narrow ? fastForwardIsolatedAnts<RngKind::MT19937, uint16_t>()
+                         : fastForwardIsolatedAnts<RngKind::MT19937, uint32_t>();
+    }
+    
+    last_check_destroyed = colonies_destroyed;
+    last_check_alive = alive_ants_count;
+    
+    // Back off while checks keep finding nothing to do
+    fast_forward_interval = retired > 0 ? FAST_FORWARD_MIN_INTERVAL
+                                        : std::min(fast_forward_interval * 2, FAST_FORWARD_MAX_INTERVAL);
+}
+
+uint32_t AntManiaSimulation::labelComponents() {
+    const uint32_t colony_count = colonyCount();
+    component_of.assign(colony_count, NO_COMPONENT);
+    component_trap_free.clear();
+    bfs_queue.resize(colony_count);
+    
+    // BFS over live tunnels in both directions: ants in different weakly
+    // connected components can never meet, and components only ever split
+    uint32_t components = 0;
+    for (uint32_t start = 0; start < colony_count; ++start) {
+        if (destroyed(start) || component_of[start] != NO_COMPONENT) continue;
+        
+        uint32_t component = components++;
+        bool trap_free = true;
+        size_t head = 0, tail = 0;
+        bfs_queue[tail++] = start;
+        component_of[start] = component;
+        
+        while (head < tail) {
+            uint32_t c = bfs_queue[head++];
+            uint8_t mask = live_masks[c];
+            if (mask == 0) trap_free = false;
             
-            // Kill all ants in this colony and update counters
-            for (auto& ant : ants) {
-                if (ant.alive && ant.colony_id == colony_id) {
-                    ant.alive = false;
-                    alive_ants_count--;
+            for (uint8_t dir = 0; dir < 4; ++dir) {
+                if (!(mask & (1u << dir))) continue;
+                uint32_t next = graph->connection(c, dir);
+                if (component_of[next] == NO_COMPONENT) {
+                    component_of[next] = component;
+                    bfs_queue[tail++] = next;
+                }
+            }
+            for (const uint32_t* e = graph->incomingBegin(c); e != graph->incomingEnd(c); ++e) {
+                uint32_t source = *e >> 2;
+                if (!destroyed(source) && component_of[source] == NO_COMPONENT) {
+                    component_of[source] = component;
+                    bfs_queue[tail++] = source;
                 }
             }
-            
-            // Report collision with first 2 ant IDs as required by spec
-            std::cout << colony_names[colony_id] << " has been destroyed by ant " 
-                     << colony_ant_ids[colony_id][0] << " and ant " 
-                     << colony_ant_ids[colony_id][1] << "!" << std::endl;
         }
+        component_trap_free.push_back(trap_free);
+    }
+    
+    component_ants.assign(components, 0);
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    for (uint32_t i = 0; i < ant_count; ++i) {
+        if (ants.alive(i)) component_ants[component_of[ants.colony_ids[i]]]++;
     }
-}
\ No newline at end of file
+    return components;
+}
+
+template <RngKind KIND, typename ColonyId>
+uint32_t AntManiaSimulation::fastForwardIsolatedAnts() {
+    uint32_t retired = 0;
+    const uint32_t ant_count = static_cast<uint32_t>(ants.size());
+    
+    for (uint32_t i = 0; i < ant_count; ++i) {
+        if (!ants.alive(i) || ants.move_counts[i] >= MAX_MOVES) continue;
+        uint32_t component = component_of[ants.colony_ids[i]];
+        if (component_ants[component] != 1) continue;
+        
+        const uint32_t moves_before = ants.move_counts[i];
+        if (component_trap_free[component]) {
+            // Can never be trapped or attacked: it will simply reach MAX_MOVES.
+            // Its final colony is never reported, so the walk itself is skipped.
+            total_ant_steps += MAX_MOVES - moves_before;
+            max_moves_ants_count++;
+        } else {
+            // A dead end is reachable, so play the walk out alone. With COUNTER
+            // draws this is exactly the walk the main loop would have produced.
+            bool trapped = false;
+            while (ants.move_counts[i] < MAX_MOVES) {
+                if constexpr (KIND == RngKind::XOSHIRO) {
+                    random_batch[i] = static_cast<uint32_t>(fast_rng() >> 32);
+                }
+                if (stepAnt<KIND, ColonyId>(i) == MoveResult::TRAPPED) {
+                    trapped = true;
+                    break;
+                }
+            }
+            total_ant_steps += ants.move_counts[i] - moves_before;
+            if (trapped) {
+                if (record_trapped) recordTrapped(i);
+                killAnt(i);
+                continue;
+            }
+            max_moves_ants_count++;
+        }
+        
+        ants.retire(i);
+        retired++;
+    }
+    return retired;
+}
+
+void AntStore::clear() {
+    colony_ids.clear();
+    move_counts.clear();
+    ant_ids.clear();
+    dead_count = 0;
+}
+
+void AntStore::reserve(size_t n) {
+    colony_ids.reserve(n);
+    move_counts.reserve(n);
+    ant_ids.reserve(n);
+}
+
+void AntStore::add(uint32_t colony_id, uint32_t ant_id) {
+    colony_ids.push_back(colony_id);
+    move_counts.push_back(0);
+    ant_ids.push_back(ant_id);
+}
+
+void AntStore::compact() {
+    // Stable, so survivors keep their relative order (and RNG draw order)
+    size_t out = 0;
+    for (size_t i = 0; i < colony_ids.size(); ++i) {
+        if (colony_ids[i] == DEAD_ANT) continue;
+        colony_ids[out] = colony_ids[i];
+        move_counts[out] = move_counts[i];
+        ant_ids[out] = ant_ids[i];
+        out++;
+    }
+    colony_ids.resize(out);
+    move_counts.resize(out);
+    ant_ids.resize(out);
+    dead_count = 0;
+}
@@ -3,72 +3,1193 @@
 #include <vector>
 #include <chrono>
 #include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+#include <sstream>
+#include "ant_mania.h"
+#include "map_generator.h"
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cout << "Usage: " << argv[0] << " <executable_path> [map_file] [ant_counts...]" << std::endl;
-        std::cout << "Example: " << argv[0] << " ./ant_mania ../hiveum_map_small.txt 50 100 500" << std::endl;
-        return 1;
+// In-process benchmark harness. Links the simulation directly, so process
+// startup is excluded and each phase (load / createAnts / simulate / output)
+// is timed on its own. Every configuration runs N times with fixed seeds.
+
+// Discards everything written to it; stands in for stdout while timing
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// Points std::cout at a NullBuffer for the guard's lifetime
+class SilenceCout {
+private:
+    NullBuffer null_buffer;
+    std::streambuf* previous;
+
+public:
+    SilenceCout() : previous(std::cout.rdbuf(&null_buffer)) {}
+    ~SilenceCout() { std::cout.rdbuf(previous); }
+};
+
+// Writes a side x side grid map with bidirectional tunnels between neighbours
+static bool writeGridMap(const std::string& filename, uint32_t side) {
+    MapGeneratorConfig config;
+    config.colonies = side * side;
+    return generateMap(config, filename);
+}
+
+static std::string baseName(const std::string& path) {
+    size_t slash_pos = path.find_last_of('/');
+    return (slash_pos != std::string::npos) ? path.substr(slash_pos + 1) : path;
+}
+
+static const char* engineName(SimulationEngine engine) {
+    switch (engine) {
+        case SimulationEngine::TWO_PASS: return "two-pass";
+        case SimulationEngine::FUSED: return "fused";
+        case SimulationEngine::PARALLEL: return "parallel";
     }
-    
-    std::string executable = argv[1];
-    std::vector<std::string> test_configs;
-    
-    // Default tests if no arguments provided
-    if (argc == 2) {
-        test_configs = {
-            "../hiveum_map_small.txt 50",
-            "../hiveum_map_small.txt 100", 
-            "../hiveum_map_medium.txt 1000",
-            "../hiveum_map_medium.txt 2000"
-        };
-    } else {
-        // Use provided arguments
-        std::string map_file = argv[2];
-        for (int i = 3; i < argc; i++) {
-            test_configs.push_back(map_file + " " + argv[i]);
-        }
-    }
-    
-    std::cout << "=== Ant Mania Benchmark ===" << std::endl;
-    std::cout << std::left << std::setw(25) << "Map & Ants" << std::setw(15) << "Time (ms)" << std::endl;
-    std::cout << std::string(40, '-') << std::endl;
-    
-    double total_time = 0;
-    
-    for (const auto& config : test_configs) {
-        std::string cmd = executable + " " + config + " > /dev/null 2>&1";
-        
+    return "unknown";
+}
+
+static const char* rngName(RngKind rng) {
+    switch (rng) {
+        case RngKind::XOSHIRO: return "xoshiro";
+        case RngKind::MT19937: return "mt19937";
+        case RngKind::COUNTER: return "counter";
+    }
+    return "unknown";
+}
+
+static const char* orderName(ColonyOrder order) {
+    switch (order) {
+        case ColonyOrder::FILE: return "file";
+        case ColonyOrder::BFS: return "bfs";
+        case ColonyOrder::RCM: return "rcm";
+    }
+    return "unknown";
+}
+
+static ColonyOrder parseOrder(const std::string& name) {
+    return name == "bfs" ? ColonyOrder::BFS : name == "rcm" ? ColonyOrder::RCM : ColonyOrder::FILE;
+}
+
+struct RunConfig {
+    std::string map_file;
+    uint32_t ants;
+    SimulationEngine engine = SimulationEngine::TWO_PASS;
+    RngKind rng = RngKind::XOSHIRO;
+    uint32_t threads = 1;
+    bool quiet = false;
+    ColonyOrder order = ColonyOrder::FILE;
+    bool vector_moves = true;
+    bool specialized = true;
+};
+
+struct RunResult {
+    double load_ms;
+    double create_ms;
+    double simulate_ms;
+    double output_ms;
+    uint32_t iterations;
+    uint64_t ant_steps;
+    uint32_t destroyed;
+    uint32_t remaining;
+};
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start,
+                        std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// One full run with every phase timed separately; all output is discarded
+static bool runOnce(const RunConfig& config, uint64_t seed, RunResult& result) {
+    SilenceCout silence;
+
+    AntManiaSimulation sim;
+    sim.setEngine(config.engine);
+    sim.setRng(config.rng);
+    sim.setThreads(config.threads);
+    sim.setQuiet(config.quiet);
+    sim.setColonyOrder(config.order);
+    sim.setVectorMoves(config.vector_moves);
+    sim.setSpecialized(config.specialized);
+    sim.setSeed(seed);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    if (!sim.loadMap(config.map_file)) return false;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    sim.createAnts(config.ants);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    sim.runSimulation();
+    auto t3 = std::chrono::high_resolution_clock::now();
+    sim.printStatistics();
+    sim.printRemainingWorld();
+    auto t4 = std::chrono::high_resolution_clock::now();
+
+    result.load_ms = elapsedMs(t0, t1);
+    result.create_ms = elapsedMs(t1, t2);
+    result.simulate_ms = elapsedMs(t2, t3);
+    result.output_ms = elapsedMs(t3, t4);
+    result.iterations = sim.getIterations();
+    result.ant_steps = sim.getAntSteps();
+    result.destroyed = sim.getColoniesDestroyed();
+    result.remaining = sim.getAntsRemaining();
+    return true;
+}
+
+struct Stats {
+    double min;
+    double median;
+    double p99;
+};
+
+// Nearest-rank percentiles over the samples
+static Stats summarize(std::vector<double> samples) {
+    if (samples.empty()) return {0, 0, 0};
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&](double pct) {
+        size_t index = static_cast<size_t>(pct / 100.0 * samples.size() + 0.999999);
+        return samples[std::clamp<size_t>(index, 1, samples.size()) - 1];
+    };
+    return {samples.front(), rank(50), rank(99)};
+}
+
+// Runs a configuration `repetitions` times (seeds 1..N) and keeps every sample
+static bool runRepeated(const RunConfig& config, int repetitions, std::vector<RunResult>& results) {
+    results.clear();
+    for (int rep = 0; rep < repetitions; rep++) {
+        RunResult result;
+        if (!runOnce(config, static_cast<uint64_t>(rep) + 1, result)) {
+            std::cerr << "Error: Could not load " << config.map_file << std::endl;
+            return false;
+        }
+        results.push_back(result);
+    }
+    return true;
+}
+
+struct ConfigReport {
+    RunConfig config;
+    int repetitions;
+    Stats phases[4];   // load, create, simulate, output
+    Stats iterations;
+    double iterations_per_sec;   // Median over runs
+    double ant_steps_per_sec;    // Median over runs
+};
+
+static const char* const PHASE_NAMES[4] = {"load", "create", "simulate", "output"};
+
+static ConfigReport buildReport(const RunConfig& config, const std::vector<RunResult>& results) {
+    ConfigReport report;
+    report.config = config;
+    report.repetitions = static_cast<int>(results.size());
+
+    std::vector<double> phase[4], iterations, iteration_rate, step_rate;
+    for (const auto& r : results) {
+        phase[0].push_back(r.load_ms);
+        phase[1].push_back(r.create_ms);
+        phase[2].push_back(r.simulate_ms);
+        phase[3].push_back(r.output_ms);
+        iterations.push_back(r.iterations);
+        double seconds = r.simulate_ms / 1000.0;
+        iteration_rate.push_back(seconds > 0 ? r.iterations / seconds : 0.0);
+        step_rate.push_back(seconds > 0 ? r.ant_steps / seconds : 0.0);
+    }
+    for (int p = 0; p < 4; p++) {
+        report.phases[p] = summarize(phase[p]);
+    }
+    report.iterations = summarize(iterations);
+    report.iterations_per_sec = summarize(iteration_rate).median;
+    report.ant_steps_per_sec = summarize(step_rate).median;
+    return report;
+}
+
+static void printTable(const std::vector<ConfigReport>& reports) {
+    std::cout << std::left << std::setw(36) << "Map & Ants" << std::setw(10) << "Phase"
+              << std::setw(11) << "Min (ms)" << std::setw(12) << "Median (ms)" << std::setw(11) << "P99 (ms)" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+
+    for (const auto& report : reports) {
+        std::string display_name = baseName(report.config.map_file) + " (" + std::to_string(report.config.ants) + " ants)";
+        for (int p = 0; p < 4; p++) {
+            std::cout << std::left << std::setw(36) << (p == 0 ? display_name : "")
+                      << std::setw(10) << PHASE_NAMES[p] << std::fixed << std::setprecision(3)
+                      << std::setw(11) << report.phases[p].min
+                      << std::setw(12) << report.phases[p].median
+                      << std::setw(11) << report.phases[p].p99 << std::endl;
+        }
+        std::cout << std::left << std::setw(36) << "" << std::setprecision(0)
+                  << "iterations " << report.iterations.median
+                  << ", " << report.iterations_per_sec << " it/s"
+                  << ", " << report.ant_steps_per_sec << " ant-steps/s" << std::endl;
+    }
+}
+
+static void writeJson(std::ostream& out, const std::vector<ConfigReport>& reports) {
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"benchmark\": \"ant_mania\",\n  \"results\": [\n";
+    for (size_t i = 0; i < reports.size(); i++) {
+        const auto& r = reports[i];
+        out << "    {\"map\": \"" << baseName(r.config.map_file) << "\", \"ants\": " << r.config.ants
+            << ", \"engine\": \"" << engineName(r.config.engine) << "\", \"rng\": \"" << rngName(r.config.rng)
+            << "\", \"order\": \"" << orderName(r.config.order)
+            << "\", \"threads\": " << r.config.threads << ", \"repetitions\": " << r.repetitions
+            << ", \"iterations_median\": " << static_cast<uint64_t>(r.iterations.median)
+            << ", \"iterations_per_sec\": " << r.iterations_per_sec
+            << ", \"ant_steps_per_sec\": " << r.ant_steps_per_sec << ", \"phases\": {";
+        for (int p = 0; p < 4; p++) {
+            out << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": {\"min_ms\": " << r.phases[p].min
+                << ", \"median_ms\": " << r.phases[p].median << ", \"p99_ms\": " << r.phases[p].p99 << "}";
+        }
+        out << "}}" << (i + 1 < reports.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static void writeCsv(std::ostream& out, const std::vector<ConfigReport>& reports) {
+    out << std::fixed << std::setprecision(4);
+    out << "map,ants,engine,rng,order,threads,repetitions,phase,min_ms,median_ms,p99_ms,"
+        << "iterations_median,iterations_per_sec,ant_steps_per_sec\n";
+    for (const auto& r : reports) {
+        for (int p = 0; p < 4; p++) {
+            out << baseName(r.config.map_file) << "," << r.config.ants << "," << engineName(r.config.engine) << ","
+                << rngName(r.config.rng) << "," << orderName(r.config.order) << "," << r.config.threads << "," << r.repetitions << ","
+                << PHASE_NAMES[p] << "," << r.phases[p].min << "," << r.phases[p].median << "," << r.phases[p].p99 << ","
+                << static_cast<uint64_t>(r.iterations.median) << "," << r.iterations_per_sec << "," << r.ant_steps_per_sec << "\n";
+        }
+    }
+}
+
+// Best-of-N load time in ms, or a negative value if the map can't be loaded
+static double bestLoadMs(const std::string& map_file, int repetitions) {
+    std::vector<double> samples;
+    for (int rep = 0; rep < repetitions; rep++) {
+        AntManiaSimulation sim;
+        SilenceCout silence;
         auto start = std::chrono::high_resolution_clock::now();
-        int result = system(cmd.c_str());
+        bool ok = sim.loadMap(map_file);
         auto end = std::chrono::high_resolution_clock::now();
-        
-        if (result == 0) {
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            double time_ms = duration.count() / 1000.0;
-            total_time += time_ms;
-            
-            // Parse config to show cleaner output
-            size_t space_pos = config.find(' ');
-            std::string map_part = config.substr(0, space_pos);
-            std::string ant_count = config.substr(space_pos + 1);
-            
-            // Extract just the map name (remove path)
-            size_t slash_pos = map_part.find_last_of('/');
-            std::string map_name = (slash_pos != std::string::npos) ? map_part.substr(slash_pos + 1) : map_part;
-            
-            std::string display_name = map_name + " (" + ant_count + " ants)";
-            
-            std::cout << std::left << std::setw(25) << display_name 
-                      << std::setw(15) << std::fixed << std::setprecision(2) << time_ms << std::endl;
+        if (!ok) return -1.0;
+        samples.push_back(elapsedMs(start, end));
+    }
+    return summarize(samples).min;
+}
+
+// Load-time benchmark: parses each map in-process and reports MB/s, then
+// compiles it to the binary format and times loading that instead
+static int runLoadBenchmark(const std::vector<std::string>& args) {
+    static constexpr int REPETITIONS = 5;
+    static constexpr uint32_t DEFAULT_GRID_SIDE = 1000;  // 1M colonies
+    static const std::string BINARY_MAP = "/tmp/ant_mania_load_benchmark.antmap";
+
+    std::vector<std::string> maps = args;
+    std::string synthetic_map;
+    if (maps.empty()) {
+        maps.push_back("../task/hiveum_map_medium.txt");
+        synthetic_map = "/tmp/ant_mania_grid_map.txt";
+        std::cout << "Generating " << DEFAULT_GRID_SIDE << "x" << DEFAULT_GRID_SIDE
+                  << " synthetic map at " << synthetic_map << "..." << std::endl;
+        if (!writeGridMap(synthetic_map, DEFAULT_GRID_SIDE)) {
+            std::cerr << "Error: Could not write " << synthetic_map << std::endl;
+            return 1;
+        }
+        maps.push_back(synthetic_map);
+    }
+
+    std::cout << "=== Ant Mania Load Benchmark ===" << std::endl;
+    std::cout << std::left << std::setw(30) << "Map" << std::setw(12) << "Size (MB)"
+              << std::setw(12) << "Best (ms)" << std::setw(12) << "MB/s" << std::setw(14) << "Binary (ms)" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+
+    int status = 0;
+    for (const auto& map_file : maps) {
+        std::ifstream probe(map_file, std::ios::binary | std::ios::ate);
+        if (!probe.is_open()) {
+            std::cout << "Error opening: " << map_file << std::endl;
+            status = 1;
+            continue;
+        }
+        double size_mb = static_cast<double>(probe.tellg()) / (1024.0 * 1024.0);
+
+        double best_ms = bestLoadMs(map_file, REPETITIONS);
+        if (best_ms < 0) {
+            status = 1;
+            continue;
+        }
+
+        bool compiled;
+        {
+            AntManiaSimulation sim;
+            SilenceCout silence;
+            compiled = sim.loadMap(map_file) && sim.compileMap(BINARY_MAP);
+        }
+        double binary_ms = compiled ? bestLoadMs(BINARY_MAP, REPETITIONS) : -1.0;
+        std::remove(BINARY_MAP.c_str());
+
+        std::cout << std::left << std::setw(30) << baseName(map_file)
+                  << std::setw(12) << std::fixed << std::setprecision(2) << size_mb
+                  << std::setw(12) << best_ms
+                  << std::setw(12) << (best_ms > 0 ? size_mb / (best_ms / 1000.0) : 0.0)
+                  << std::setw(14) << binary_ms << std::endl;
+    }
+
+    if (!synthetic_map.empty()) std::remove(synthetic_map.c_str());
+    return status;
+}
+
+// Same colony IDs, names and tunnels, e.g. from a parallel vs a sequential load
+static bool sameGraph(const ColonyGraph& a, const ColonyGraph& b) {
+    if (a.size() != b.size()) return false;
+    for (uint32_t c = 0; c < a.size(); ++c) {
+        if (a.name(c) != b.name(c) || a.connections(c) != b.connections(c)) return false;
+    }
+    return true;
+}
+
+// Text-map load throughput at 1/2/4/8/16 loader threads. Every configuration is
+// checked against the sequential load, which must produce identical colony IDs.
+static int runLoadScalingBenchmark(const std::vector<std::string>& args, int repetitions) {
+    static constexpr uint32_t DEFAULT_GRID_SIDE = 1500;  // 2.25M colonies
+    static constexpr uint32_t THREAD_COUNTS[] = {1, 2, 4, 8, 16};
+
+    std::string map_file;
+    bool synthetic = args.empty();
+    if (synthetic) {
+        map_file = "/tmp/ant_mania_grid_map.txt";
+        std::cout << "Generating " << DEFAULT_GRID_SIDE << "x" << DEFAULT_GRID_SIDE
+                  << " synthetic map at " << map_file << "..." << std::endl;
+        if (!writeGridMap(map_file, DEFAULT_GRID_SIDE)) {
+            std::cerr << "Error: Could not write " << map_file << std::endl;
+            return 1;
+        }
+    } else {
+        map_file = args[0];
+    }
+
+    std::ifstream probe(map_file, std::ios::binary | std::ios::ate);
+    double size_mb = probe.is_open() ? static_cast<double>(probe.tellg()) / (1024.0 * 1024.0) : 0.0;
+    ColonyGraph reference;
+    if (!reference.load(map_file)) return 1;
+
+    std::cout << "=== Ant Mania Parallel Load (" << baseName(map_file) << ", " << std::fixed << std::setprecision(1)
+              << size_mb << " MB, " << std::thread::hardware_concurrency() << " hardware threads) ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Threads" << std::setw(12) << "Best (ms)" << std::setw(10) << "MB/s"
+              << std::setw(10) << "Speedup" << "Same IDs" << std::endl;
+    std::cout << std::string(50, '-') << std::endl;
+
+    double baseline_ms = 0;
+    int status = 0;
+    for (uint32_t threads : THREAD_COUNTS) {
+        std::vector<double> samples;
+        bool same = true;
+        for (int rep = 0; rep < repetitions; rep++) {
+            ColonyGraph graph;
+            auto start = std::chrono::high_resolution_clock::now();
+            bool ok = graph.load(map_file, threads);
+            auto end = std::chrono::high_resolution_clock::now();
+            if (!ok) return 1;
+            samples.push_back(elapsedMs(start, end));
+            if (rep == 0) same = sameGraph(reference, graph);
+        }
+        if (!same) status = 1;
+
+        double best_ms = summarize(samples).min;
+        if (threads == 1) baseline_ms = best_ms;
+        std::cout << std::left << std::setw(10) << threads << std::fixed << std::setprecision(2)
+                  << std::setw(12) << best_ms << std::setw(10) << (best_ms > 0 ? size_mb / (best_ms / 1000.0) : 0.0)
+                  << std::setw(10) << (best_ms > 0 ? baseline_ms / best_ms : 0.0) << (same ? "yes" : "NO") << std::endl;
+    }
+
+    if (synthetic) std::remove(map_file.c_str());
+    return status;
+}
+
+// Simulate-time A/B of engines and RNGs on the same seeded workloads
+static int runEngineBenchmark(const std::vector<std::string>& args, int repetitions) {
+    std::string map_file = !args.empty() ? args[0] : "../task/hiveum_map_medium.txt";
+    std::vector<uint32_t> ant_counts;
+    for (size_t i = 1; i < args.size(); i++) {
+        ant_counts.push_back(std::stoul(args[i]));
+    }
+    if (ant_counts.empty()) ant_counts = {100, 1000, 5000};
+
+    const SimulationEngine engines[] = {SimulationEngine::TWO_PASS, SimulationEngine::FUSED};
+    const RngKind rngs[] = {RngKind::XOSHIRO, RngKind::MT19937};
+
+    std::cout << "=== Ant Mania Engine Benchmark (" << map_file << ") ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Ants" << std::setw(12) << "Engine" << std::setw(10) << "RNG"
+              << std::setw(12) << "Min (ms)" << std::setw(12) << "Median (ms)" << std::endl;
+    std::cout << std::string(56, '-') << std::endl;
+
+    std::vector<RunResult> results;
+    for (uint32_t ants : ant_counts) {
+        for (SimulationEngine engine : engines) {
+            for (RngKind rng : rngs) {
+                RunConfig config{map_file, ants, engine, rng};
+                if (!runRepeated(config, repetitions, results)) return 1;
+
+                std::vector<double> simulate;
+                for (const auto& r : results) simulate.push_back(r.simulate_ms);
+                Stats stats = summarize(simulate);
+                std::cout << std::left << std::setw(10) << ants << std::setw(12) << engineName(engine)
+                          << std::setw(10) << rngName(rng) << std::setw(12) << std::fixed << std::setprecision(2)
+                          << stats.min << std::setw(12) << stats.median << std::endl;
+            }
+        }
+    }
+    return 0;
+}
+
+// Parallel engine scaling at 1/2/4/8/16 threads, with a result fingerprint per run
+static int runScalingBenchmark(const std::vector<std::string>& args, int repetitions) {
+    static constexpr uint32_t DEFAULT_GRID_SIDE = 500;
+    static constexpr uint32_t THREAD_COUNTS[] = {1, 2, 4, 8, 16};
+
+    std::string map_file;
+    bool synthetic = args.empty();
+    if (synthetic) {
+        map_file = "/tmp/ant_mania_grid_map.txt";
+        std::cout << "Generating " << DEFAULT_GRID_SIDE << "x" << DEFAULT_GRID_SIDE
+                  << " synthetic map at " << map_file << "..." << std::endl;
+        if (!writeGridMap(map_file, DEFAULT_GRID_SIDE)) {
+            std::cerr << "Error: Could not write " << map_file << std::endl;
+            return 1;
+        }
+    } else {
+        map_file = args[0];
+    }
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 250000;
+
+    std::cout << "=== Ant Mania Thread Scaling (" << ants << " ants, " << std::thread::hardware_concurrency()
+              << " hardware threads) ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Threads" << std::setw(12) << "Min (ms)"
+              << std::setw(10) << "Speedup" << "Result (destroyed/remaining)" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+
+    double baseline_ms = 0;
+    std::vector<RunResult> results;
+    for (uint32_t threads : THREAD_COUNTS) {
+        RunConfig config{map_file, ants, SimulationEngine::PARALLEL, RngKind::COUNTER, threads};
+
+        // Same seed at every thread count, so the fingerprint must not change
+        results.clear();
+        for (int rep = 0; rep < repetitions; rep++) {
+            RunResult result;
+            if (!runOnce(config, 1, result)) {
+                std::cerr << "Error: Could not load " << map_file << std::endl;
+                return 1;
+            }
+            results.push_back(result);
+        }
+
+        std::vector<double> simulate;
+        for (const auto& r : results) simulate.push_back(r.simulate_ms);
+        double best_ms = summarize(simulate).min;
+        if (threads == 1) baseline_ms = best_ms;
+        std::cout << std::left << std::setw(10) << threads
+                  << std::setw(12) << std::fixed << std::setprecision(2) << best_ms
+                  << std::setw(10) << (best_ms > 0 ? baseline_ms / best_ms : 0.0)
+                  << results.back().destroyed << "/" << results.back().remaining << std::endl;
+    }
+
+    if (synthetic) std::remove(map_file.c_str());
+    return 0;
+}
+
+// Colony renumbering A/B: the same seeded runs with IDs in file, BFS and RCM order.
+// By default the map is a shuffled grid, whose file order has no locality at all.
+static int runLocalityBenchmark(const std::vector<std::string>& args, const MapGeneratorConfig& generated,
+                                const RunConfig& base, int repetitions) {
+    static const ColonyOrder ORDERS[] = {ColonyOrder::FILE, ColonyOrder::BFS, ColonyOrder::RCM};
+
+    std::string map_file;
+    bool synthetic = args.empty();
+    if (synthetic) {
+        map_file = "/tmp/ant_mania_locality_map.txt";
+        std::cout << "Generating " << generated.colonies << " colonies ("
+                  << (generated.topology == MapTopology::GRID ? "grid" : "random") << ", shuffled) at "
+                  << map_file << "..." << std::endl;
+        if (!generateMap(generated, map_file)) {
+            std::cerr << "Error: Could not write " << map_file << std::endl;
+            return 1;
+        }
+    } else {
+        map_file = args[0];
+    }
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 100000;
+
+    std::cout << "=== Ant Mania Colony Order (" << ants << " ants, " << engineName(base.engine) << ", "
+              << repetitions << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(8) << "Order" << std::setw(12) << "Load (ms)" << std::setw(12) << "Min (ms)"
+              << std::setw(13) << "Median (ms)" << std::setw(10) << "Speedup" << "Result (destroyed/remaining)"
+              << std::endl;
+    std::cout << std::string(83, '-') << std::endl;
+
+    double baseline_ms = 0;
+    std::vector<RunResult> results;
+    for (ColonyOrder order : ORDERS) {
+        RunConfig config = base;
+        config.map_file = map_file;
+        config.ants = ants;
+        config.order = order;
+        if (!runRepeated(config, repetitions, results)) return 1;
+
+        // Load includes the reordering pass
+        ConfigReport report = buildReport(config, results);
+        if (order == ColonyOrder::FILE) baseline_ms = report.phases[2].median;
+        std::cout << std::left << std::setw(8) << orderName(order) << std::fixed << std::setprecision(2)
+                  << std::setw(12) << report.phases[0].median << std::setw(12) << report.phases[2].min
+                  << std::setw(13) << report.phases[2].median
+                  << std::setw(10) << (report.phases[2].median > 0 ? baseline_ms / report.phases[2].median : 0.0)
+                  << results.back().destroyed << "/" << results.back().remaining << std::endl;
+    }
+
+    if (synthetic) std::remove(map_file.c_str());
+    return 0;
+}
+
+// Move kernel A/B: scalar loop vs AVX2 kernel on the same seeded runs, per engine and RNG
+static int runSimdBenchmark(const std::vector<std::string>& args, int repetitions) {
+    static constexpr uint32_t DEFAULT_GRID_SIDE = 500;
+    const SimulationEngine engines[] = {SimulationEngine::TWO_PASS, SimulationEngine::FUSED};
+    const RngKind rngs[] = {RngKind::XOSHIRO, RngKind::COUNTER};
+
+    std::string map_file;
+    bool synthetic = args.empty();
+    if (synthetic) {
+        map_file = "/tmp/ant_mania_grid_map.txt";
+        std::cout << "Generating " << DEFAULT_GRID_SIDE << "x" << DEFAULT_GRID_SIDE
+                  << " synthetic map at " << map_file << "..." << std::endl;
+        if (!writeGridMap(map_file, DEFAULT_GRID_SIDE)) {
+            std::cerr << "Error: Could not write " << map_file << std::endl;
+            return 1;
+        }
+    } else {
+        map_file = args[0];
+    }
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 100000;
+
+    std::cout << "=== Ant Mania Move Kernel (" << ants << " ants, AVX2 "
+              << (moveKernelAvailable() ? "available" : "not available, both rows scalar") << ") ===" << std::endl;
+    std::cout << std::left << std::setw(11) << "Engine" << std::setw(9) << "RNG" << std::setw(8) << "Kernel"
+              << std::setw(12) << "Min (ms)" << std::setw(13) << "Median (ms)" << std::setw(10) << "Speedup"
+              << "Result (destroyed/remaining)" << std::endl;
+    std::cout << std::string(91, '-') << std::endl;
+
+    std::vector<RunResult> results;
+    for (SimulationEngine engine : engines) {
+        for (RngKind rng : rngs) {
+            double scalar_ms = 0;
+            for (bool vector_moves : {false, true}) {
+                RunConfig config{map_file, ants, engine, rng};
+                config.vector_moves = vector_moves;
+                if (!runRepeated(config, repetitions, results)) return 1;
+
+                std::vector<double> simulate;
+                for (const auto& r : results) simulate.push_back(r.simulate_ms);
+                Stats stats = summarize(simulate);
+                if (!vector_moves) scalar_ms = stats.median;
+                std::cout << std::left << std::setw(11) << engineName(engine) << std::setw(9) << rngName(rng)
+                          << std::setw(8) << (vector_moves ? "avx2" : "scalar") << std::fixed << std::setprecision(2)
+                          << std::setw(12) << stats.min << std::setw(13) << stats.median
+                          << std::setw(10) << (stats.median > 0 ? scalar_ms / stats.median : 0.0)
+                          << results.back().destroyed << "/" << results.back().remaining << std::endl;
+            }
+        }
+    }
+
+    if (synthetic) std::remove(map_file.c_str());
+    return 0;
+}
+
+// Checkpoint cost: simulate time at several checkpoint intervals, plus a resume from
+// the last checkpoint that must finish with the same result as the uninterrupted run
+static int runCheckpointBenchmark(const std::vector<std::string>& args, const RunConfig& base, int repetitions) {
+    static constexpr uint32_t INTERVALS[] = {0, 1000, 100, 10};
+    const std::string checkpoint_file = "/tmp/ant_mania_benchmark.ckpt";
+    std::string map_file = !args.empty() ? args[0] : "../task/hiveum_map_medium.txt";
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 5000;
+
+    std::cout << "=== Ant Mania Checkpoints (" << map_file << ", " << ants << " ants, "
+              << repetitions << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Interval" << std::setw(12) << "Min (ms)" << std::setw(13) << "Median (ms)"
+              << std::setw(11) << "Relative" << std::setw(12) << "Size (KB)" << std::setw(13) << "Resume (ms)"
+              << "Resumed result" << std::endl;
+    std::cout << std::string(85, '-') << std::endl;
+
+    double baseline_ms = 0;
+    for (uint32_t interval : INTERVALS) {
+        std::vector<double> simulate;
+        std::string fingerprint, resumed_fingerprint = "-";
+        double resume_ms = 0;
+        double size_kb = 0;
+        for (int rep = 0; rep < repetitions; rep++) {
+            SilenceCout silence;
+            AntManiaSimulation sim;
+            sim.setEngine(base.engine);
+            sim.setRng(base.rng);
+            sim.setThreads(base.threads);
+            sim.setQuiet(true);
+            sim.setSeed(1);
+            if (!sim.loadMap(map_file)) {
+                std::cerr << "Error: Could not load " << map_file << std::endl;
+                return 1;
+            }
+            sim.createAnts(ants);
+            if (interval != 0) sim.setCheckpoint(checkpoint_file, interval);
+            auto start = std::chrono::high_resolution_clock::now();
+            sim.runSimulation();
+            simulate.push_back(elapsedMs(start, std::chrono::high_resolution_clock::now()));
+            fingerprint = std::to_string(sim.getColoniesDestroyed()) + "/" + std::to_string(sim.getAntsRemaining()) +
+                          "/" + std::to_string(sim.getAntSteps());
+            if (interval == 0 || rep + 1 < repetitions) continue;
+
+            // Same graph, fresh state restored from the last checkpoint
+            std::ifstream file(checkpoint_file, std::ios::binary | std::ios::ate);
+            size_kb = static_cast<double>(file.tellg()) / 1024.0;
+            AntManiaSimulation resumed;
+            resumed.setSilent(true);
+            resumed.setThreads(base.threads);
+            resumed.setGraph(sim.getGraph());
+            auto resume_start = std::chrono::high_resolution_clock::now();
+            if (!resumed.restoreCheckpoint(checkpoint_file)) return 1;
+            resume_ms = elapsedMs(resume_start, std::chrono::high_resolution_clock::now());
+            resumed.runSimulation();
+            resumed_fingerprint = std::to_string(resumed.getColoniesDestroyed()) + "/" +
+                                  std::to_string(resumed.getAntsRemaining()) + "/" +
+                                  std::to_string(resumed.getAntSteps());
+            resumed_fingerprint += resumed_fingerprint == fingerprint ? " (same)" : " (DIFFERENT)";
+        }
+
+        Stats stats = summarize(simulate);
+        if (interval == 0) baseline_ms = stats.median;
+        std::cout << std::left << std::setw(10) << (interval == 0 ? std::string("off") : std::to_string(interval))
+                  << std::fixed << std::setprecision(2) << std::setw(12) << stats.min << std::setw(13) << stats.median
+                  << std::setw(11) << (baseline_ms > 0 ? stats.median / baseline_ms : 0.0)
+                  << std::setw(12) << size_kb << std::setw(13) << resume_ms << resumed_fingerprint << std::endl;
+    }
+    std::remove(checkpoint_file.c_str());
+    return 0;
+}
+
+// Counts every event, trapped ants included, so the run records them
+struct CountingObserver : NullObserver {
+    uint64_t events = 0;
+    void colonyDestroyed(const ColonyDestroyedEvent&) { events++; }
+    void antTrapped(const AntTrappedEvent&) { events++; }
+    void iterationEnd(const IterationEndEvent&) { events++; }
+};
+
+// Observer cost: the console observer (quiet), the no-op observer and one that takes every event
+static int runObserverBenchmark(const std::vector<std::string>& args, const RunConfig& base, int repetitions) {
+    std::string map_file = !args.empty() ? args[0] : "../task/hiveum_map_medium.txt";
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 5000;
+    const char* observers[] = {"console", "null", "counting"};
+
+    std::cout << "=== Ant Mania Observers (" << map_file << ", " << ants << " ants, "
+              << repetitions << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Observer" << std::setw(12) << "Min (ms)" << std::setw(13) << "Median (ms)"
+              << std::setw(11) << "Relative" << "Result (destroyed/remaining)" << std::endl;
+    std::cout << std::string(74, '-') << std::endl;
+
+    double console_ms = 0;
+    for (int observer = 0; observer < 3; ++observer) {
+        std::vector<double> simulate;
+        std::string fingerprint;
+        for (int rep = 0; rep < repetitions; rep++) {
+            SilenceCout silence;
+            AntManiaSimulation sim;
+            sim.setEngine(base.engine);
+            sim.setRng(base.rng);
+            sim.setThreads(base.threads);
+            sim.setQuiet(true);
+            sim.setSeed(rep + 1);
+            if (!sim.loadMap(map_file)) {
+                std::cerr << "Error: Could not load " << map_file << std::endl;
+                return 1;
+            }
+            sim.createAnts(ants);
+            auto start = std::chrono::high_resolution_clock::now();
+            if (observer == 0) {
+                sim.runSimulation();
+            } else if (observer == 1) {
+                NullObserver none;
+                sim.run(none);
+            } else {
+                CountingObserver counting;
+                sim.run(counting);
+            }
+            simulate.push_back(elapsedMs(start, std::chrono::high_resolution_clock::now()));
+            fingerprint = std::to_string(sim.getColoniesDestroyed()) + "/" + std::to_string(sim.getAntsRemaining());
+        }
+
+        Stats stats = summarize(simulate);
+        if (observer == 0) console_ms = stats.median;
+        std::cout << std::left << std::setw(10) << observers[observer] << std::fixed << std::setprecision(2)
+                  << std::setw(12) << stats.min << std::setw(13) << stats.median
+                  << std::setw(11) << (console_ms > 0 ? stats.median / console_ms : 0.0) << fingerprint << std::endl;
+    }
+    return 0;
+}
+
+// Specialized policy instantiation vs the generic, per-iteration dispatched one
+static int runPolicyBenchmark(const std::vector<std::string>& args, const RunConfig& base, int repetitions) {
+    std::string map_file = !args.empty() ? args[0] : "../task/hiveum_map_medium.txt";
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 5000;
+    const std::pair<SimulationEngine, RngKind> configs[] = {
+        {SimulationEngine::TWO_PASS, RngKind::XOSHIRO}, {SimulationEngine::TWO_PASS, RngKind::COUNTER},
+        {SimulationEngine::FUSED, RngKind::XOSHIRO}, {SimulationEngine::FUSED, RngKind::COUNTER},
+        {SimulationEngine::PARALLEL, RngKind::COUNTER}};
+
+    std::cout << "=== Ant Mania Policies (" << map_file << ", " << ants << " ants, "
+              << repetitions << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(11) << "Engine" << std::setw(9) << "RNG" << std::setw(13) << "Policy"
+              << std::setw(12) << "Min (ms)" << std::setw(13) << "Median (ms)" << std::setw(10) << "Speedup"
+              << "Result (destroyed/remaining)" << std::endl;
+    std::cout << std::string(96, '-') << std::endl;
+
+    std::vector<RunResult> results;
+    for (const auto& [engine, rng] : configs) {
+        double generic_ms = 0;
+        for (bool specialized : {false, true}) {
+            RunConfig config = base;
+            config.map_file = map_file;
+            config.ants = ants;
+            config.engine = engine;
+            config.rng = rng;
+            config.quiet = true;
+            config.specialized = specialized;
+            if (!runRepeated(config, repetitions, results)) return 1;
+
+            std::vector<double> simulate;
+            for (const auto& r : results) simulate.push_back(r.simulate_ms);
+            Stats stats = summarize(simulate);
+            if (!specialized) generic_ms = stats.median;
+            std::cout << std::left << std::setw(11) << engineName(engine) << std::setw(9) << rngName(rng)
+                      << std::setw(13) << (specialized ? "specialized" : "generic") << std::fixed << std::setprecision(2)
+                      << std::setw(12) << stats.min << std::setw(13) << stats.median
+                      << std::setw(10) << (stats.median > 0 ? generic_ms / stats.median : 0.0)
+                      << results.back().destroyed << "/" << results.back().remaining << std::endl;
+        }
+    }
+    return 0;
+}
+
+// Page backing A/B: the same seeded runs with the map tables and run state on the heap,
+// on transparent huge pages (with and without prefaulting) and on explicit huge pages.
+// dTLB misses come from perf_event_open on the simulating thread, where permitted;
+// "Huge MB" is what the kernel actually backed with huge pages at the end of the run.
+static int runHugePageBenchmark(const std::vector<std::string>& args, const MapGeneratorConfig& generated,
+                                const RunConfig& base, int repetitions) {
+    struct Mode {
+        const char* name;
+        MemoryOptions options;
+    };
+    const Mode modes[] = {{"off", {HugePages::OFF, false, false}},
+                          {"thp", {HugePages::TRANSPARENT, false, false}},
+                          {"thp+pf", {HugePages::TRANSPARENT, true, false}},
+                          {"explicit", {HugePages::EXPLICIT, false, false}}};
+
+    std::string map_file;
+    bool synthetic = args.empty();
+    if (synthetic) {
+        map_file = "/tmp/ant_mania_huge_page_map.txt";
+        std::cout << "Generating " << generated.colonies << " colonies (shuffled grid) at " << map_file << "..."
+                  << std::endl;
+        if (!generateMap(generated, map_file)) {
+            std::cerr << "Error: Could not write " << map_file << std::endl;
+            return 1;
+        }
+    } else {
+        map_file = args[0];
+    }
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 200000;
+
+    std::cout << "=== Ant Mania Huge Pages (" << ants << " ants, " << engineName(base.engine) << ", "
+              << repetitions << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Pages" << std::setw(12) << "Load (ms)" << std::setw(12) << "Min (ms)"
+              << std::setw(13) << "Median (ms)" << std::setw(10) << "Speedup" << std::setw(15) << "dTLB misses"
+              << std::setw(11) << "Arena MB" << std::setw(9) << "Huge MB" << "Result (destroyed/remaining)" << std::endl;
+    std::cout << std::string(120, '-') << std::endl;
+
+    double baseline_ms = 0;
+    bool counters_available = false;
+    for (const Mode& mode : modes) {
+        std::vector<double> load, simulate;
+        std::vector<double> tlb_misses;
+        double arena_mb = 0, huge_mb = 0;
+        std::string result;
+        for (int rep = 0; rep < repetitions; rep++) {
+            SilenceCout silence;
+            AntManiaSimulation sim;
+            sim.setEngine(base.engine);
+            sim.setRng(base.rng);
+            sim.setThreads(base.threads);
+            sim.setColonyOrder(base.order);
+            sim.setQuiet(true);
+            sim.setSeed(rep + 1);
+            sim.setMemoryOptions(mode.options);
+            auto load_start = std::chrono::high_resolution_clock::now();
+            if (!sim.loadMap(map_file)) return 1;
+            load.push_back(elapsedMs(load_start, std::chrono::high_resolution_clock::now()));
+            sim.createAnts(ants);
+
+            PerfCounters perf;
+            uint64_t before[PERF_EVENT_COUNT], after[PERF_EVENT_COUNT];
+            perf.open();
+            perf.read(before);
+            auto start = std::chrono::high_resolution_clock::now();
+            sim.runSimulation();
+            simulate.push_back(elapsedMs(start, std::chrono::high_resolution_clock::now()));
+            perf.read(after);
+            if (perf.isActive()) {
+                const size_t tlb = static_cast<size_t>(PerfEvent::DTLB_MISSES);
+                tlb_misses.push_back(static_cast<double>(after[tlb] - before[tlb]));
+                counters_available = true;
+            }
+
+            if (rep + 1 < repetitions) continue;
+            const HugePageArena& graph_memory = sim.getGraph()->getMemory();
+            arena_mb = (graph_memory.stats().used_bytes + sim.getMemory().stats().used_bytes) / 1048576.0;
+            huge_mb = (graph_memory.residentHugeBytes() + sim.getMemory().residentHugeBytes()) / 1048576.0;
+            result = std::to_string(sim.getColoniesDestroyed()) + "/" + std::to_string(sim.getAntsRemaining());
+        }
+
+        Stats stats = summarize(simulate);
+        if (baseline_ms == 0) baseline_ms = stats.median;
+        std::cout << std::left << std::setw(10) << mode.name << std::fixed << std::setprecision(2)
+                  << std::setw(12) << summarize(load).median << std::setw(12) << stats.min << std::setw(13) << stats.median
+                  << std::setw(10) << (stats.median > 0 ? baseline_ms / stats.median : 0.0) << std::setw(15)
+                  << (tlb_misses.empty() ? std::string("n/a") : std::to_string(static_cast<uint64_t>(summarize(tlb_misses).median)))
+                  << std::setprecision(1) << std::setw(11) << arena_mb << std::setw(9) << huge_mb << result << std::endl;
+    }
+    if (!counters_available) std::cout << "dTLB counters unavailable (perf_event_open failed)" << std::endl;
+
+    if (synthetic) std::remove(map_file.c_str());
+    return 0;
+}
+
+// Resumable runs: the blocking run() against the same run driven in step(n) and runFor()
+// slices, and several simulations round-robined on one thread. Reports total simulate
+// time and the latency of individual slices, which is what bounds an event loop's stall.
+static int runSteppingBenchmark(const std::vector<std::string>& args, const RunConfig& base, int repetitions) {
+    using Clock = std::chrono::steady_clock;
+    struct Mode {
+        const char* name;
+        uint32_t steps;               // step(n) slices; 0 = runFor(budget), UINT32_MAX = run()
+        std::chrono::microseconds budget;
+        uint32_t simulations;         // Interleaved round-robin
+    };
+    const Mode modes[] = {{"run", UINT32_MAX, {}, 1},
+                          {"step 1", 1, {}, 1},
+                          {"step 64", 64, {}, 1},
+                          {"runFor 100us", 0, std::chrono::microseconds(100), 1},
+                          {"runFor 1ms", 0, std::chrono::microseconds(1000), 1},
+                          {"4x runFor 1ms", 0, std::chrono::microseconds(1000), 4}};
+    std::string map_file = !args.empty() ? args[0] : "../task/hiveum_map_medium.txt";
+    uint32_t ants = args.size() > 1 ? std::stoul(args[1]) : 5000;
+
+    std::cout << "=== Ant Mania Stepping (" << map_file << ", " << ants << " ants, " << engineName(base.engine)
+              << ", " << repetitions << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(15) << "Mode" << std::setw(14) << "ms per run" << std::setw(10) << "Relative"
+              << std::setw(9) << "Slices" << std::setw(13) << "Slice p50" << std::setw(13) << "Slice p99"
+              << std::setw(13) << "Slice max" << "Result (destroyed/remaining)" << std::endl;
+    std::cout << std::string(114, '-') << std::endl;
+
+    double baseline_ms = 0;
+    for (const Mode& mode : modes) {
+        std::vector<double> per_run_ms, slice_us;
+        std::string result;
+        for (int rep = 0; rep < repetitions; rep++) {
+            std::vector<std::unique_ptr<AntManiaSimulation>> sims;
+            for (uint32_t k = 0; k < mode.simulations; ++k) {
+                auto sim = std::make_unique<AntManiaSimulation>();
+                sim->setSilent(true);
+                sim->setEngine(base.engine);
+                sim->setRng(base.rng);
+                sim->setThreads(base.threads);
+                sim->setSeed(rep + 1);
+                if (!sim->loadMap(map_file)) {
+                    std::cerr << "Error: Could not load " << map_file << std::endl;
+                    return 1;
+                }
+                sim->createAnts(ants);
+                sims.push_back(std::move(sim));
+            }
+
+            NullObserver none;
+            auto start = Clock::now();
+            for (bool active = true; active;) {
+                active = false;
+                for (auto& sim : sims) {
+                    if (sim->getRunState() == RunState::FINISHED) continue;
+                    auto slice_start = Clock::now();
+                    StepResult progress = mode.steps == UINT32_MAX ? (sim->run(none), StepResult{0, 0, 0, 0, true})
+                                        : mode.steps > 0         ? sim->step(none, mode.steps)
+                                                                 : sim->runFor(none, mode.budget);
+                    slice_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - slice_start).count());
+                    active |= !progress.finished;
+                }
+            }
+            per_run_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count() / sims.size());
+            result = std::to_string(sims.back()->getColoniesDestroyed()) + "/" +
+                     std::to_string(sims.back()->getAntsRemaining());
+        }
+
+        Stats stats = summarize(per_run_ms);
+        Stats slices = summarize(slice_us);
+        if (baseline_ms == 0) baseline_ms = stats.median;
+        std::cout << std::left << std::setw(15) << mode.name << std::fixed << std::setprecision(2)
+                  << std::setw(14) << stats.median << std::setw(10) << (baseline_ms > 0 ? stats.median / baseline_ms : 0.0)
+                  << std::setw(9) << slice_us.size() / repetitions << std::setprecision(1)
+                  << std::setw(13) << slices.median << std::setw(13) << slices.p99
+                  << std::setw(13) << *std::max_element(slice_us.begin(), slice_us.end()) << result << std::endl;
+    }
+    std::cout << "Slice latencies in microseconds" << std::endl;
+    return 0;
+}
+
+// Comma-separated list of counts, e.g. "1000,10000"
+static std::vector<uint32_t> parseCounts(const std::string& list) {
+    std::vector<uint32_t> counts;
+    size_t begin = 0;
+    while (begin < list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) end = list.size();
+        if (end > begin) counts.push_back(std::stoul(list.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    return counts;
+}
+
+// Ants x colonies sweep on generated maps: how simulate time scales with map size
+static std::vector<ConfigReport> runScalingSweep(const MapGeneratorConfig& base_map, const RunConfig& base,
+                                                 const std::vector<uint32_t>& colony_counts,
+                                                 const std::vector<uint32_t>& ant_counts, int repetitions,
+                                                 std::ostream& log) {
+    std::vector<ConfigReport> reports;
+    std::vector<RunResult> results;
+
+    log << "=== Ant Mania Scaling Sweep (" << (base_map.topology == MapTopology::GRID ? "grid" : "random")
+              << (base_map.shuffle_lines ? " shuffled" : "") << ", " << base_map.missing_edge_ratio * 100
+              << "% missing edges, " << orderName(base.order) << " order, " << repetitions
+              << " runs per cell) ===" << std::endl;
+    log << "Simulate median ms (ns per ant-step)" << std::endl;
+    log << std::left << std::setw(12) << "Colonies";
+    for (uint32_t ants : ant_counts) log << std::setw(22) << (std::to_string(ants) + " ants");
+    log << std::endl;
+    log << std::string(12 + 22 * ant_counts.size(), '-') << std::endl;
+
+    for (uint32_t colonies : colony_counts) {
+        MapGeneratorConfig map_config = base_map;
+        map_config.colonies = colonies;
+        std::string map_file = "/tmp/ant_mania_sweep_" + std::to_string(colonies) + ".txt";
+        if (!generateMap(map_config, map_file)) {
+            std::cerr << "Error: Could not write " << map_file << std::endl;
+            break;
+        }
+
+        log << std::left << std::setw(12) << colonies << std::flush;
+        for (uint32_t ants : ant_counts) {
+            RunConfig config = base;
+            config.map_file = map_file;
+            config.ants = ants;
+            if (!runRepeated(config, repetitions, results)) break;
+            reports.push_back(buildReport(config, results));
+
+            const ConfigReport& report = reports.back();
+            double ns_per_step = report.ant_steps_per_sec > 0 ? 1e9 / report.ant_steps_per_sec : 0.0;
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(2) << report.phases[2].median << " (" << std::setprecision(1)
+                 << ns_per_step << ")";
+            log << std::setw(22) << cell.str() << std::flush;
+        }
+        log << std::endl;
+        std::remove(map_file.c_str());
+    }
+    return reports;
+}
+
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] [map_file ant_counts...]" << std::endl;
+    std::cout << "       " << program << " --load [map_files...]" << std::endl;
+    std::cout << "       " << program << " --load-scaling [map_file]" << std::endl;
+    std::cout << "       " << program << " --engines [map_file] [ant_counts...]" << std::endl;
+    std::cout << "       " << program << " --scaling [map_file] [ant_count]" << std::endl;
+    std::cout << "       " << program << " --sweep [--colonies N,N,...] [--ants N,N,...] [--topology grid|random]"
+              << " [--missing-edges RATIO] [--shuffle]" << std::endl;
+    std::cout << "       " << program << " --locality [map_file] [ant_count] (default: shuffled 4M-colony map)"
+              << std::endl;
+    std::cout << "       " << program << " --simd [map_file] [ant_count]" << std::endl;
+    std::cout << "       " << program << " --checkpoint [map_file] [ant_count]" << std::endl;
+    std::cout << "       " << program << " --observer [map_file] [ant_count]" << std::endl;
+    std::cout << "       " << program << " --policies [map_file] [ant_count]" << std::endl;
+    std::cout << "       " << program << " --stepping [map_file] [ant_count]" << std::endl;
+    std::cout << "       " << program << " --huge-pages [map_file] [ant_count] (default: shuffled 1M-colony grid)"
+              << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --repetitions N                 Runs per configuration (seeds 1..N, default 10)" << std::endl;
+    std::cout << "  --engine two-pass|fused|parallel" << std::endl;
+    std::cout << "  --rng xoshiro|mt19937|counter" << std::endl;
+    std::cout << "  --threads N                     Threads for the parallel engine" << std::endl;
+    std::cout << "  --quiet                         Count destruction messages without formatting them" << std::endl;
+    std::cout << "  --no-simd                       Scalar move loop instead of the AVX2 kernel" << std::endl;
+    std::cout << "  --generic-policy                Runtime-dispatched iteration path instead of a specialized one" << std::endl;
+    std::cout << "  --reorder file|bfs|rcm          Colony numbering used by the simulation" << std::endl;
+    std::cout << "  --format table|json|csv         Report format (default table)" << std::endl;
+    std::cout << "  --output FILE                   Write the json/csv report to FILE" << std::endl;
+    std::cout << "  --colonies, --ants              Sweep grid (default 10000,100000,1000000 x 1000,10000,100000)" << std::endl;
+    std::cout << "Example: " << program << " --repetitions 20 --format json --output bench.json "
+              << "../task/hiveum_map_medium.txt 1000 2000" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode;
+    std::string format = "table";
+    std::string output_file;
+    int repetitions = 0;  // 0 = mode default
+    RunConfig base{"", 0};
+    MapGeneratorConfig sweep_map;
+    std::vector<uint32_t> sweep_colonies = {10000, 100000, 1000000};
+    std::vector<uint32_t> sweep_ants = {1000, 10000, 100000};
+    std::vector<std::string> positional;
+    bool colonies_given = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--load" || arg == "--load-scaling" || arg == "--engines" || arg == "--scaling" || arg == "--sweep" || arg == "--locality" || arg == "--simd" || arg == "--checkpoint" || arg == "--observer" || arg == "--policies" || arg == "--huge-pages" || arg == "--stepping") {
+            mode = arg;
+        } else if (arg == "--repetitions" && has_value) {
+            repetitions = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--engine" && has_value) {
+            std::string name = argv[++i];
+            base.engine = name == "fused" ? SimulationEngine::FUSED
+                        : name == "parallel" ? SimulationEngine::PARALLEL : SimulationEngine::TWO_PASS;
+        } else if (arg == "--rng" && has_value) {
+            std::string name = argv[++i];
+            base.rng = name == "mt19937" ? RngKind::MT19937
+                     : name == "counter" ? RngKind::COUNTER : RngKind::XOSHIRO;
+        } else if (arg == "--threads" && has_value) {
+            base.threads = std::stoul(argv[++i]);
+        } else if (arg == "--quiet") {
+            base.quiet = true;
+        } else if (arg == "--no-simd") {
+            base.vector_moves = false;
+        } else if (arg == "--generic-policy") {
+            base.specialized = false;
+        } else if (arg == "--reorder" && has_value) {
+            base.order = parseOrder(argv[++i]);
+        } else if (arg == "--format" && has_value) {
+            format = argv[++i];
+        } else if (arg == "--output" && has_value) {
+            output_file = argv[++i];
+        } else if (arg == "--colonies" && has_value) {
+            sweep_colonies = parseCounts(argv[++i]);
+            colonies_given = !sweep_colonies.empty();
+        } else if (arg == "--ants" && has_value) {
+            sweep_ants = parseCounts(argv[++i]);
+        } else if (arg == "--topology" && has_value) {
+            sweep_map.topology = std::string(argv[++i]) == "random" ? MapTopology::RANDOM : MapTopology::GRID;
+        } else if (arg == "--missing-edges" && has_value) {
+            sweep_map.missing_edge_ratio = std::stod(argv[++i]);
+        } else if (arg == "--shuffle") {
+            sweep_map.shuffle_lines = true;
+        } else if (arg == "--help" || arg == "-h" || arg.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return arg.rfind("--", 0) == 0 && arg != "--help" ? 1 : 0;
         } else {
-            std::cout << "Error running: " << config << std::endl;
+            positional.push_back(arg);
+        }
+    }
+
+    // Large generated maps are slow, so those modes default to fewer runs
+    if (repetitions == 0) {
+        repetitions = (mode == "--sweep" || mode == "--locality" || mode == "--load-scaling" || mode == "--huge-pages") ? 3 : 10;
+    }
+
+    if (mode == "--load") return runLoadBenchmark(positional);
+    if (mode == "--load-scaling") return runLoadScalingBenchmark(positional, repetitions);
+    if (mode == "--engines") return runEngineBenchmark(positional, repetitions);
+    if (mode == "--scaling") return runScalingBenchmark(positional, repetitions);
+    if (mode == "--simd") return runSimdBenchmark(positional, repetitions);
+    if (mode == "--checkpoint") return runCheckpointBenchmark(positional, base, repetitions);
+    if (mode == "--observer") return runObserverBenchmark(positional, base, repetitions);
+    if (mode == "--policies") return runPolicyBenchmark(positional, base, repetitions);
+    if (mode == "--stepping") return runSteppingBenchmark(positional, base, repetitions);
+    if (mode == "--huge-pages") {
+        MapGeneratorConfig huge_page_map = sweep_map;
+        huge_page_map.colonies = colonies_given ? sweep_colonies.front() : 1000000;
+        huge_page_map.shuffle_lines = true;
+        return runHugePageBenchmark(positional, huge_page_map, base, repetitions);
+    }
+    if (mode == "--locality") {
+        MapGeneratorConfig locality_map = sweep_map;
+        locality_map.colonies = colonies_given ? sweep_colonies.front() : 4000000;
+        locality_map.shuffle_lines = true;
+        return runLocalityBenchmark(positional, locality_map, base, repetitions);
+    }
+
+    // JSON/CSV on stdout must not be interleaved with the human-readable table
+    bool machine_to_stdout = format != "table" && output_file.empty();
+
+    std::vector<ConfigReport> reports;
+    std::vector<RunResult> results;
+    std::vector<RunConfig> configs;
+    if (mode == "--sweep") {
+        reports = runScalingSweep(sweep_map, base, sweep_colonies, sweep_ants, repetitions,
+                                  machine_to_stdout ? std::cerr : std::cout);
+    } else if (positional.empty()) {
+        // Default tests if no arguments provided
+        for (const auto& [map_file, ants] : std::vector<std::pair<std::string, uint32_t>>{
+                 {"../task/hiveum_map_small.txt", 50},
+                 {"../task/hiveum_map_small.txt", 100},
+                 {"../task/hiveum_map_medium.txt", 1000},
+                 {"../task/hiveum_map_medium.txt", 2000}}) {
+            RunConfig config = base;
+            config.map_file = map_file;
+            config.ants = ants;
+            configs.push_back(config);
+        }
+    } else {
+        for (size_t i = 1; i < positional.size(); i++) {
+            RunConfig config = base;
+            config.map_file = positional[0];
+            config.ants = std::stoul(positional[i]);
+            configs.push_back(config);
+        }
+    }
+    if (mode != "--sweep" && configs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    for (const auto& config : configs) {
+        if (!runRepeated(config, repetitions, results)) return 1;
+        reports.push_back(buildReport(config, results));
+    }
+
+    // Machine-readable report goes to the output file, or replaces the table on stdout
+    std::ofstream file;
+    if (!output_file.empty()) {
+        file.open(output_file);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write " << output_file << std::endl;
+            return 1;
         }
     }
-    
-    std::cout << std::string(40, '-') << std::endl;
-    std::cout << "Average time: " << std::fixed << std::setprecision(2) 
-              << (total_time / test_configs.size()) << " ms" << std::endl;
-    
+    std::ostream& machine_out = output_file.empty() ? std::cout : file;
+
+    if (mode != "--sweep" && !machine_to_stdout) {
+        std::cout << "=== Ant Mania Benchmark (" << repetitions << " runs per config, "
+                  << engineName(base.engine) << ", " << rngName(base.rng) << ") ===" << std::endl;
+        printTable(reports);
+    }
+    if (format == "json") writeJson(machine_out, reports);
+    if (format == "csv") writeCsv(machine_out, reports);
+
     return 0;
 }
@@ -0,0 +1,156 @@
+#include "binary_map.h"
+
+#include <cstring>
+#include <fstream>
+
+static constexpr uint32_t NO_CONNECTION = UINT32_MAX;
+
+static constexpr uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t{7};
+}
+
+// Byte offset of each section, derived from the counts in the header
+struct SectionLayout {
+    uint64_t connections;
+    uint64_t reverse_offsets;
+    uint64_t reverse_edges;
+    uint64_t name_offsets;
+    uint64_t names;
+    uint64_t end;
+};
+
+static SectionLayout layoutFor(uint32_t colony_count, uint32_t edge_count, uint64_t name_bytes) {
+    SectionLayout layout;
+    layout.connections = align8(sizeof(BinaryMapHeader));
+    layout.reverse_offsets = align8(layout.connections + uint64_t{colony_count} * 4 * sizeof(uint32_t));
+    layout.reverse_edges = align8(layout.reverse_offsets + (uint64_t{colony_count} + 1) * sizeof(uint32_t));
+    layout.name_offsets = align8(layout.reverse_edges + uint64_t{edge_count} * sizeof(uint32_t));
+    layout.names = align8(layout.name_offsets + (uint64_t{colony_count} + 1) * sizeof(uint32_t));
+    layout.end = layout.names + name_bytes;
+    return layout;
+}
+
+bool isBinaryMap(std::string_view data) {
+    return data.size() >= sizeof(BINARY_MAP_MAGIC) &&
+           std::memcmp(data.data(), BINARY_MAP_MAGIC, sizeof(BINARY_MAP_MAGIC)) == 0;
+}
+
+bool parseBinaryMap(std::string_view data, BinaryMapView& view, std::string& error) {
+    if (data.size() < sizeof(BinaryMapHeader) || !isBinaryMap(data)) {
+        error = "not a binary map";
+        return false;
+    }
+
+    BinaryMapHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.version != BINARY_MAP_VERSION) {
+        error = "unsupported binary map version " + std::to_string(header.version) +
+                " (expected " + std::to_string(BINARY_MAP_VERSION) + ")";
+        return false;
+    }
+    if (header.byte_order != BINARY_MAP_BYTE_ORDER) {
+        error = "binary map was compiled on a machine with different byte order";
+        return false;
+    }
+
+    SectionLayout layout = layoutFor(header.colony_count, header.edge_count, header.name_bytes);
+    if (header.file_size != data.size() || layout.end != data.size()) {
+        error = "binary map is truncated or corrupt";
+        return false;
+    }
+
+    const char* base = data.data();
+    view.colony_count = header.colony_count;
+    view.edge_count = header.edge_count;
+    view.name_bytes = header.name_bytes;
+    view.connections = reinterpret_cast<const uint32_t*>(base + layout.connections);
+    view.reverse_offsets = reinterpret_cast<const uint32_t*>(base + layout.reverse_offsets);
+    view.reverse_edges = reinterpret_cast<const uint32_t*>(base + layout.reverse_edges);
+    view.name_offsets = reinterpret_cast<const uint32_t*>(base + layout.name_offsets);
+    view.names = base + layout.names;
+
+    // Every index is range-checked once here, so the simulation can trust them
+    const uint64_t connection_count = uint64_t{view.colony_count} * 4;
+    uint64_t tunnel_count = 0;
+    for (uint64_t i = 0; i < connection_count; ++i) {
+        uint32_t target = view.connections[i];
+        if (target == NO_CONNECTION) continue;
+        if (target >= view.colony_count) {
+            error = "binary map has a connection out of range";
+            return false;
+        }
+        tunnel_count++;
+    }
+    for (uint32_t c = 0; c < view.colony_count; ++c) {
+        if (view.reverse_offsets[c] > view.reverse_offsets[c + 1] ||
+            view.name_offsets[c] >= view.name_offsets[c + 1]) {
+            error = "binary map has an invalid offset table";
+            return false;
+        }
+    }
+    if (view.reverse_offsets[0] != 0 || view.reverse_offsets[view.colony_count] != view.edge_count ||
+        view.name_offsets[0] != 0 || view.name_offsets[view.colony_count] != view.name_bytes) {
+        error = "binary map has an invalid offset table";
+        return false;
+    }
+    for (uint32_t e = 0; e < view.edge_count; ++e) {
+        if ((view.reverse_edges[e] >> 2) >= view.colony_count) {
+            error = "binary map has a reverse edge out of range";
+            return false;
+        }
+    }
+    
+    // The reverse index is used as stored, so it must be exactly the one the connections
+    // imply: every entry is a tunnel into its colony, entries ascend (none repeats), and
+    // there is one per tunnel
+    if (tunnel_count != view.edge_count) {
+        error = "binary map's reverse index does not match its connections";
+        return false;
+    }
+    for (uint32_t c = 0; c < view.colony_count; ++c) {
+        for (uint32_t e = view.reverse_offsets[c]; e < view.reverse_offsets[c + 1]; ++e) {
+            uint32_t edge = view.reverse_edges[e];
+            if (view.connections[edge] != c || (e > view.reverse_offsets[c] && edge <= view.reverse_edges[e - 1])) {
+                error = "binary map's reverse index does not match its connections";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool writeBinaryMap(const std::string& filename, const BinaryMapView& view) {
+    // Name offsets are 32-bit
+    if (view.name_bytes > UINT32_MAX) return false;
+
+    SectionLayout layout = layoutFor(view.colony_count, view.edge_count, view.name_bytes);
+
+    BinaryMapHeader header{};
+    std::memcpy(header.magic, BINARY_MAP_MAGIC, sizeof(BINARY_MAP_MAGIC));
+    header.version = BINARY_MAP_VERSION;
+    header.byte_order = BINARY_MAP_BYTE_ORDER;
+    header.colony_count = view.colony_count;
+    header.edge_count = view.edge_count;
+    header.name_bytes = view.name_bytes;
+    header.file_size = layout.end;
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    uint64_t written = 0;
+    auto section = [&](uint64_t offset, const void* bytes, uint64_t size) {
+        static constexpr char PADDING[8] = {};
+        out.write(PADDING, static_cast<std::streamsize>(offset - written));
+        out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+        written = offset + size;
+    };
+
+    section(0, &header, sizeof(header));
+    section(layout.connections, view.connections, uint64_t{view.colony_count} * 4 * sizeof(uint32_t));
+    section(layout.reverse_offsets, view.reverse_offsets, (uint64_t{view.colony_count} + 1) * sizeof(uint32_t));
+    section(layout.reverse_edges, view.reverse_edges, uint64_t{view.edge_count} * sizeof(uint32_t));
+    section(layout.name_offsets, view.name_offsets, (uint64_t{view.colony_count} + 1) * sizeof(uint32_t));
+    section(layout.names, view.names, view.name_bytes);
+
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,263 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "mapped_file.h"
+
+namespace {
+
+constexpr uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t colony_count;
+    uint32_t edge_count;
+    uint8_t colony_order;
+    uint8_t rng_kind;
+    uint8_t engine;
+    uint8_t fast_forward;
+    uint32_t ant_count;
+    uint64_t seed;
+    uint64_t xoshiro_state[4];
+    uint32_t iterations;
+    uint32_t total_ants;
+    uint32_t colonies_destroyed;
+    uint32_t total_fight_pairs;
+    uint32_t alive_ants_count;
+    uint32_t max_moves_ants_count;
+    uint32_t dead_count;
+    uint32_t fast_forward_interval;
+    uint32_t fast_forward_countdown;
+    uint32_t last_check_destroyed;
+    uint32_t last_check_alive;
+    uint32_t mt_state_bytes;
+    uint64_t total_ant_steps;
+    uint64_t message_count;
+    uint64_t file_size;  // Detects truncated files
+};
+
+constexpr uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t{7};
+}
+
+struct CheckpointLayout {
+    uint64_t colony_ids;
+    uint64_t move_counts;
+    uint64_t ant_ids;
+    uint64_t destroyed_bits;
+    uint64_t mt_state;
+    uint64_t end;
+};
+
+CheckpointLayout layoutFor(uint64_t ant_count, uint64_t bitmap_words, uint64_t mt_state_bytes) {
+    CheckpointLayout layout;
+    layout.colony_ids = align8(sizeof(CheckpointHeader));
+    layout.move_counts = align8(layout.colony_ids + ant_count * sizeof(uint32_t));
+    layout.ant_ids = align8(layout.move_counts + ant_count * sizeof(uint16_t));
+    layout.destroyed_bits = align8(layout.ant_ids + ant_count * sizeof(uint32_t));
+    layout.mt_state = align8(layout.destroyed_bits + bitmap_words * sizeof(uint64_t));
+    layout.end = layout.mt_state + mt_state_bytes;
+    return layout;
+}
+
+uint64_t bitmapWords(uint32_t colony_count) {
+    return (uint64_t{colony_count} + 63) / 64;
+}
+
+}  // namespace
+
+bool writeCheckpoint(const std::string& filename, const SimulationSnapshot& snapshot) {
+    const uint64_t ant_count = snapshot.colony_ids.size();
+    if (snapshot.move_counts.size() != ant_count || snapshot.ant_ids.size() != ant_count ||
+        snapshot.destroyed_bits.size() != bitmapWords(snapshot.colony_count)) {
+        return false;
+    }
+    CheckpointLayout layout = layoutFor(ant_count, snapshot.destroyed_bits.size(), snapshot.mt_state.size());
+
+    CheckpointHeader header{};  // Zeroed, so padding bytes are deterministic
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.byte_order = CHECKPOINT_BYTE_ORDER;
+    header.colony_count = snapshot.colony_count;
+    header.edge_count = snapshot.edge_count;
+    header.colony_order = snapshot.colony_order;
+    header.rng_kind = snapshot.rng_kind;
+    header.engine = snapshot.engine;
+    header.fast_forward = snapshot.fast_forward;
+    header.ant_count = static_cast<uint32_t>(ant_count);
+    header.seed = snapshot.seed;
+    std::memcpy(header.xoshiro_state, snapshot.xoshiro_state.data(), sizeof(header.xoshiro_state));
+    header.iterations = snapshot.iterations;
+    header.total_ants = snapshot.total_ants;
+    header.colonies_destroyed = snapshot.colonies_destroyed;
+    header.total_fight_pairs = snapshot.total_fight_pairs;
+    header.alive_ants_count = snapshot.alive_ants_count;
+    header.max_moves_ants_count = snapshot.max_moves_ants_count;
+    header.dead_count = snapshot.dead_count;
+    header.fast_forward_interval = snapshot.fast_forward_interval;
+    header.fast_forward_countdown = snapshot.fast_forward_countdown;
+    header.last_check_destroyed = snapshot.last_check_destroyed;
+    header.last_check_alive = snapshot.last_check_alive;
+    header.mt_state_bytes = static_cast<uint32_t>(snapshot.mt_state.size());
+    header.total_ant_steps = snapshot.total_ant_steps;
+    header.message_count = snapshot.message_count;
+    header.file_size = layout.end;
+
+    const std::string temp = filename + ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    uint64_t written = 0;
+    auto section = [&](uint64_t offset, const void* data, uint64_t bytes) {
+        static const char zeros[8] = {};
+        out.write(zeros, static_cast<std::streamsize>(offset - written));
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written = offset + bytes;
+    };
+    section(0, &header, sizeof(header));
+    section(layout.colony_ids, snapshot.colony_ids.data(), ant_count * sizeof(uint32_t));
+    section(layout.move_counts, snapshot.move_counts.data(), ant_count * sizeof(uint16_t));
+    section(layout.ant_ids, snapshot.ant_ids.data(), ant_count * sizeof(uint32_t));
+    section(layout.destroyed_bits, snapshot.destroyed_bits.data(), snapshot.destroyed_bits.size() * sizeof(uint64_t));
+    section(layout.mt_state, snapshot.mt_state.data(), snapshot.mt_state.size());
+
+    out.close();
+    if (!out) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return std::rename(temp.c_str(), filename.c_str()) == 0;
+}
+
+bool readCheckpoint(const std::string& filename, SimulationSnapshot& snapshot, std::string& error) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    const char* base = file.data();
+    CheckpointHeader header;
+    if (file.size() < sizeof(header) || std::memcmp(base, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        error = "not a checkpoint";
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (header.version != CHECKPOINT_VERSION) {
+        error = "unsupported checkpoint version " + std::to_string(header.version) +
+                " (expected " + std::to_string(CHECKPOINT_VERSION) + ")";
+        return false;
+    }
+    if (header.byte_order != CHECKPOINT_BYTE_ORDER) {
+        error = "checkpoint was written on a machine with different byte order";
+        return false;
+    }
+
+    const uint64_t ant_count = header.ant_count;
+    const uint64_t bitmap_words = bitmapWords(header.colony_count);
+    CheckpointLayout layout = layoutFor(ant_count, bitmap_words, header.mt_state_bytes);
+    if (header.file_size != file.size() || layout.end != file.size()) {
+        error = "checkpoint is truncated or corrupt";
+        return false;
+    }
+
+    snapshot.colony_count = header.colony_count;
+    snapshot.edge_count = header.edge_count;
+    snapshot.colony_order = header.colony_order;
+    snapshot.rng_kind = header.rng_kind;
+    snapshot.engine = header.engine;
+    snapshot.fast_forward = header.fast_forward;
+    snapshot.seed = header.seed;
+    std::memcpy(snapshot.xoshiro_state.data(), header.xoshiro_state, sizeof(header.xoshiro_state));
+    snapshot.iterations = header.iterations;
+    snapshot.total_ants = header.total_ants;
+    snapshot.colonies_destroyed = header.colonies_destroyed;
+    snapshot.total_fight_pairs = header.total_fight_pairs;
+    snapshot.alive_ants_count = header.alive_ants_count;
+    snapshot.max_moves_ants_count = header.max_moves_ants_count;
+    snapshot.dead_count = header.dead_count;
+    snapshot.fast_forward_interval = header.fast_forward_interval;
+    snapshot.fast_forward_countdown = header.fast_forward_countdown;
+    snapshot.last_check_destroyed = header.last_check_destroyed;
+    snapshot.last_check_alive = header.last_check_alive;
+    snapshot.total_ant_steps = header.total_ant_steps;
+    snapshot.message_count = header.message_count;
+
+    snapshot.colony_ids.resize(ant_count);
+    snapshot.move_counts.resize(ant_count);
+    snapshot.ant_ids.resize(ant_count);
+    snapshot.destroyed_bits.resize(bitmap_words);
+    std::memcpy(snapshot.colony_ids.data(), base + layout.colony_ids, ant_count * sizeof(uint32_t));
+    std::memcpy(snapshot.move_counts.data(), base + layout.move_counts, ant_count * sizeof(uint16_t));
+    std::memcpy(snapshot.ant_ids.data(), base + layout.ant_ids, ant_count * sizeof(uint32_t));
+    std::memcpy(snapshot.destroyed_bits.data(), base + layout.destroyed_bits, bitmap_words * sizeof(uint64_t));
+    snapshot.mt_state.assign(base + layout.mt_state, header.mt_state_bytes);
+
+    // Ant positions are trusted by the hot loop, so range-check them once here
+    for (uint32_t colony_id : snapshot.colony_ids) {
+        if (colony_id != UINT32_MAX && colony_id >= header.colony_count) {
+            error = "checkpoint has an ant position out of range";
+            return false;
+        }
+    }
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter()
+    : pending_ready(false)
+    , stopping(false)
+    , failed(false) {}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (!writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    writer.join();
+}
+
+void CheckpointWriter::submit(SimulationSnapshot& snapshot, const std::string& filename) {
+    if (!writer.joinable()) {
+        writer = std::thread(&CheckpointWriter::writerLoop, this);
+    }
+
+    // Wait for the previous write, then swap buffers so the caller refills the old one
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !pending_ready; });
+    std::swap(pending, snapshot);
+    pending_path = filename;
+    pending_ready = true;
+    lock.unlock();
+    cv.notify_all();
+}
+
+bool CheckpointWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !pending_ready; });
+    bool ok = !failed;
+    failed = false;
+    return ok;
+}
+
+void CheckpointWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return pending_ready || stopping; });
+        if (pending_ready) {
+            lock.unlock();
+            bool ok = writeCheckpoint(pending_path, pending);
+            lock.lock();
+            if (!ok) failed = true;
+            pending_ready = false;
+            cv.notify_all();
+        } else {
+            return;
+        }
+    }
+}
@@ -0,0 +1,501 @@
+#include "colony_graph.h"
+#include "binary_map.h"
+#include "name_index.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Next whitespace-separated token in [p, eol), advancing p; empty at the end of the line
+std::string_view nextToken(const char*& p, const char* eol) {
+    while (p < eol && isSpace(*p)) ++p;
+    const char* token_begin = p;
+    while (p < eol && !isSpace(*p)) ++p;
+    return std::string_view(token_begin, p - token_begin);
+}
+
+// Splits a direction=target token; anything else is INVALID and skipped
+Direction parseTunnel(std::string_view token, std::string_view& target) {
+    size_t eq_pos = token.find('=');
+    if (eq_pos == std::string_view::npos) return Direction::INVALID;
+    target = token.substr(eq_pos + 1);
+    return ColonyGraph::direction_to_enum(token.substr(0, eq_pos));
+}
+
+}  // namespace
+
+ColonyGraph::ColonyGraph()
+    : narrow_connections(ArenaAllocator<Connections<uint16_t>>(&memory))
+    , wide_connections(ArenaAllocator<Connections<uint32_t>>(&memory))
+    , live_masks(ArenaAllocator<uint8_t>(&memory))
+    , reverse_offsets(ArenaAllocator<uint32_t>(&memory))
+    , reverse_edges(ArenaAllocator<uint32_t>(&memory))
+    , name_offsets(nullptr)
+    , name_blob(nullptr) {}
+
+bool ColonyGraph::load(const std::string& filename, uint32_t threads) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    
+    file_index_of.clear();
+    colony_at_file_index.clear();
+    if (isBinaryMap(file.view())) {
+        if (!loadBinaryMap(std::move(file), filename)) return false;
+    } else if (threads <= 1 || !parseMapParallel(file.view(), threads)) {
+        parseMap(file.view());
+    }
+    
+    return true;
+}
+
+bool ColonyGraph::loadBinaryMap(MappedFile&& file, const std::string& filename) {
+    BinaryMapView view;
+    std::string error;
+    if (!parseBinaryMap(file.view(), view, error)) {
+        std::cerr << "Error: " << filename << ": " << error << std::endl;
+        return false;
+    }
+    
+    // Connections and the reverse index are bulk copies; nothing is tokenized or hashed
+    std::vector<Connections<uint32_t>> connections(view.colony_count);
+    std::memcpy(connections.data(), view.connections, sizeof(Connections<uint32_t>) * view.colony_count);
+    assignConnections(std::move(connections));
+    reverse_offsets.assign(view.reverse_offsets, view.reverse_offsets + view.colony_count + 1);
+    reverse_edges.assign(view.reverse_edges, view.reverse_edges + view.edge_count);
+    
+    // Names are used in place, so the mapping lives as long as the map
+    owned_names.clear();
+    owned_name_offsets.clear();
+    name_offsets = view.name_offsets;
+    name_blob = view.names;
+    binary_map = std::move(file);
+    return true;
+}
+
+bool ColonyGraph::compile(const std::string& filename) const {
+    // The binary format stores colonies in file order
+    if (isReordered()) {
+        std::cerr << "Error: Cannot compile a reordered map" << std::endl;
+        return false;
+    }
+    
+    std::vector<uint32_t> connections;
+    connections.reserve(size() * 4);
+    for (uint32_t c = 0; c < size(); ++c) {
+        for (uint8_t dir = 0; dir < 4; ++dir) {
+            connections.push_back(connection(c, dir));
+        }
+    }
+    
+    BinaryMapView view;
+    view.colony_count = size();
+    view.edge_count = static_cast<uint32_t>(reverse_edges.size());
+    view.name_bytes = name_offsets ? name_offsets[size()] : 0;
+    view.connections = connections.data();
+    view.reverse_offsets = reverse_offsets.data();
+    view.reverse_edges = reverse_edges.data();
+    view.name_offsets = name_offsets;
+    view.names = name_blob;
+    
+    if (!writeBinaryMap(filename, view)) {
+        std::cerr << "Error: Could not write " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ColonyGraph::parseMap(std::string_view text) {
+    std::vector<Connections<uint32_t>> colonies;
+    owned_names.clear();
+    owned_name_offsets.assign(1, 0);
+    binary_map.close();
+    
+    // Upper bound on colony count: one per line
+    size_t max_colonies = static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1;
+    colonies.reserve(max_colonies);
+    owned_name_offsets.reserve(max_colonies + 1);
+    
+    // Only needed while parsing; names are compared in the owned_names arena
+    NameIndex name_to_id(owned_names, owned_name_offsets);
+    name_to_id.reserve(max_colonies);
+    
+    // Connections to colonies defined later in the file, resolved after the pass
+    struct PendingConnection {
+        uint32_t colony_id;
+        uint8_t dir;
+        uint32_t hash;            // Computed at the first lookup, reused by the fix-up
+        std::string_view target;  // Points into text
+    };
+    std::vector<PendingConnection> pending;
+    
+    const char* pos = text.data();
+    const char* const end = text.data() + text.size();
+    
+    while (pos < end) {
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!eol) eol = end;
+        
+        // Colony name is the first token
+        const char* p = pos;
+        std::string_view name = nextToken(p, eol);
+        if (name.empty()) {  // Empty line
+            pos = eol + 1;
+            continue;
+        }
+        
+        uint32_t colony_id = static_cast<uint32_t>(colonies.size());
+        owned_names.append(name);
+        owned_name_offsets.push_back(static_cast<uint32_t>(owned_names.size()));
+        name_to_id.insert(name, NameIndex::hash(name), colony_id);
+        
+        Connections<uint32_t> colony;
+        colony.fill(NO_CONNECTION);
+        
+        // Remaining tokens are direction=target pairs
+        for (std::string_view token = nextToken(p, eol); !token.empty(); token = nextToken(p, eol)) {
+            // Skip invalid directions explicitly
+            std::string_view target;
+            Direction dir = parseTunnel(token, target);
+            if (dir == Direction::INVALID) continue;
+            
+            uint32_t hash = NameIndex::hash(target);
+            uint32_t target_id = name_to_id.find(target, hash);
+            if (target_id != NameIndex::NOT_FOUND) {
+                colony[static_cast<uint8_t>(dir)] = target_id;
+            } else {
+                pending.push_back({colony_id, static_cast<uint8_t>(dir), hash, target});
+            }
+        }
+        
+        colonies.push_back(colony);
+        pos = eol + 1;
+    }
+    
+    // Deferred fix-ups for forward references; unknown targets stay unconnected
+    for (const auto& fixup : pending) {
+        uint32_t target_id = name_to_id.find(fixup.target, fixup.hash);
+        if (target_id != NameIndex::NOT_FOUND) {
+            colonies[fixup.colony_id][fixup.dir] = target_id;
+        }
+    }
+    
+    name_offsets = owned_name_offsets.data();
+    name_blob = owned_names.data();
+    
+    assignConnections(std::move(colonies));
+    buildNeighborIndex();
+}
+
+bool ColonyGraph::parseMapParallel(std::string_view text, uint32_t threads) {
+    static constexpr size_t MIN_CHUNK_BYTES = 1 << 16;
+    
+    const uint32_t chunks = static_cast<uint32_t>(std::min<size_t>(threads, text.size() / MIN_CHUNK_BYTES));
+    if (chunks < 2) return false;
+    binary_map.close();
+    
+    // Line-aligned chunk boundaries: each one starts just after a newline
+    const char* const begin = text.data();
+    const char* const end = begin + text.size();
+    std::vector<const char*> bounds(chunks + 1, end);
+    bounds[0] = begin;
+    for (uint32_t k = 1; k < chunks; ++k) {
+        const char* p = std::max(begin + text.size() * k / chunks, bounds[k - 1]);
+        const char* newline = p < end ? static_cast<const char*>(std::memchr(p, '\n', end - p)) : nullptr;
+        bounds[k] = newline ? newline + 1 : end;
+    }
+    
+    ThreadPool pool(chunks);
+    
+    // Phase 1: every chunk finds its colony names and hashes them
+    struct ParsedLine {
+        std::string_view name;  // Tunnel tokens follow it, up to eol
+        const char* eol;
+        uint32_t hash;
+    };
+    std::vector<std::vector<ParsedLine>> lines(chunks);
+    pool.run(chunks, [&](uint32_t k) {
+        for (const char* pos = bounds[k]; pos < bounds[k + 1];) {
+            const char* eol = static_cast<const char*>(std::memchr(pos, '\n', bounds[k + 1] - pos));
+            if (!eol) eol = bounds[k + 1];
+            const char* p = pos;
+            std::string_view name = nextToken(p, eol);
+            if (!name.empty()) lines[k].push_back({name, eol, NameIndex::hash(name)});
+            pos = eol + 1;
+        }
+    });
+    
+    // Phase 2: IDs follow file order, so a chunk's first ID and name offset are prefix sums
+    std::vector<uint32_t> first_id(chunks + 1, 0);
+    std::vector<size_t> first_byte(chunks + 1, 0);
+    for (uint32_t k = 0; k < chunks; ++k) {
+        size_t bytes = 0;
+        for (const ParsedLine& line : lines[k]) bytes += line.name.size();
+        first_id[k + 1] = first_id[k] + static_cast<uint32_t>(lines[k].size());
+        first_byte[k + 1] = first_byte[k] + bytes;
+    }
+    const uint32_t colony_count = first_id[chunks];
+    
+    owned_names.resize(first_byte[chunks]);
+    owned_name_offsets.resize(colony_count + 1);
+    owned_name_offsets[0] = 0;
+    std::vector<uint32_t> hashes(colony_count);
+    pool.run(chunks, [&](uint32_t k) {
+        size_t offset = first_byte[k];
+        for (uint32_t j = 0; j < lines[k].size(); ++j) {
+            const ParsedLine& line = lines[k][j];
+            std::memcpy(owned_names.data() + offset, line.name.data(), line.name.size());
+            offset += line.name.size();
+            owned_name_offsets[first_id[k] + j + 1] = static_cast<uint32_t>(offset);
+            hashes[first_id[k] + j] = line.hash;
+        }
+    });
+    
+    // The index is partitioned by hash; each partition inserts its names in ID order.
+    // A repeated name makes tunnel targets depend on position, so that case (never
+    // produced by valid maps) is left to the sequential parser.
+    auto partition_of = [chunks](uint32_t hash) { return static_cast<uint32_t>((uint64_t{hash} * chunks) >> 32); };
+    std::vector<NameIndex> indexes;
+    indexes.reserve(chunks);
+    for (uint32_t k = 0; k < chunks; ++k) indexes.emplace_back(owned_names, owned_name_offsets);
+    std::atomic<bool> repeated{false};
+    pool.run(chunks, [&](uint32_t k) {
+        NameIndex& index = indexes[k];
+        index.reserve(colony_count / chunks + colony_count / (chunks * 8) + 16);
+        for (uint32_t id = 0; id < colony_count; ++id) {
+            if (partition_of(hashes[id]) != k) continue;
+            std::string_view name(owned_names.data() + owned_name_offsets[id],
+                                  owned_name_offsets[id + 1] - owned_name_offsets[id]);
+            if (!index.insert(name, hashes[id], id)) repeated.store(true, std::memory_order_relaxed);
+        }
+    });
+    if (repeated) return false;
+    
+    // Phase 3: resolve tunnels. The sequential parser applies a target defined at or
+    // before the line immediately and a later one as a fix-up after the pass, so for
+    // each direction the last later-defined target wins over the last earlier one.
+    std::vector<Connections<uint32_t>> colonies(colony_count);
+    pool.run(chunks, [&](uint32_t k) {
+        for (uint32_t j = 0; j < lines[k].size(); ++j) {
+            const ParsedLine& line = lines[k][j];
+            const uint32_t colony_id = first_id[k] + j;
+            Connections<uint32_t> immediate, deferred;
+            immediate.fill(NO_CONNECTION);
+            deferred.fill(NO_CONNECTION);
+            
+            const char* p = line.name.data() + line.name.size();
+            for (std::string_view token = nextToken(p, line.eol); !token.empty(); token = nextToken(p, line.eol)) {
+                std::string_view target;
+                Direction dir = parseTunnel(token, target);
+                if (dir == Direction::INVALID) continue;
+                
+                uint32_t hash = NameIndex::hash(target);
+                uint32_t target_id = indexes[partition_of(hash)].find(target, hash);
+                if (target_id == NameIndex::NOT_FOUND) continue;  // Unknown targets stay unconnected
+                (target_id <= colony_id ? immediate : deferred)[static_cast<uint8_t>(dir)] = target_id;
+            }
+            for (uint8_t dir = 0; dir < 4; ++dir) {
+                colonies[colony_id][dir] = deferred[dir] != NO_CONNECTION ? deferred[dir] : immediate[dir];
+            }
+        }
+    });
+    
+    name_offsets = owned_name_offsets.data();
+    name_blob = owned_names.data();
+    
+    assignConnections(std::move(colonies));
+    buildNeighborIndex();
+    return true;
+}
+
+void ColonyGraph::assignConnections(std::vector<Connections<uint32_t>>&& connections) {
+    const uint32_t colony_count = static_cast<uint32_t>(connections.size());
+    const bool narrow = colony_count > 0 && colony_count < NARROW_ID_LIMIT;
+    uint32_t edge_count = 0;
+    for (const Connections<uint32_t>& colony : connections) {
+        for (uint32_t target : colony) edge_count += target != NO_CONNECTION;
+    }
+    
+    // Every table the hot loop reads, reserved together so they share one arena block
+    memory.reserve(arenaGrowth(live_masks, colony_count) + arenaGrowth(reverse_offsets, colony_count + 1) +
+                   arenaGrowth(reverse_edges, edge_count) +
+                   (narrow ? arenaGrowth(narrow_connections, colony_count) : arenaGrowth(wide_connections, colony_count)));
+    live_masks.reserve(colony_count);
+    reverse_offsets.reserve(colony_count + 1);
+    reverse_edges.reserve(edge_count);
+    if (narrow) {
+        narrow_connections.reserve(colony_count);
+    } else {
+        wide_connections.reserve(colony_count);
+    }
+    
+    live_masks.resize(colony_count);
+    for (uint32_t c = 0; c < colony_count; ++c) {
+        uint8_t mask = 0;
+        for (uint8_t dir = 0; dir < 4; ++dir) {
+            if (connections[c][dir] != NO_CONNECTION) mask |= 1u << dir;
+        }
+        live_masks[c] = mask;
+    }
+    
+    // NO_CONNECTION truncates to the narrow all-ones value, which no colony uses
+    if (narrow) {
+        narrow_connections.resize(colony_count);
+        for (uint32_t c = 0; c < colony_count; ++c) {
+            for (uint8_t dir = 0; dir < 4; ++dir) {
+                narrow_connections[c][dir] = static_cast<uint16_t>(connections[c][dir]);
+            }
+        }
+        ArenaVector<Connections<uint32_t>>(wide_connections.get_allocator()).swap(wide_connections);
+    } else {
+        // The parse buffer is on the heap, so the wide table is copied into the arena
+        wide_connections.assign(connections.begin(), connections.end());
+        ArenaVector<Connections<uint16_t>>(narrow_connections.get_allocator()).swap(narrow_connections);
+    }
+}
+
+void ColonyGraph::buildNeighborIndex() {
+    const uint32_t colony_count = size();
+    reverse_offsets.assign(colony_count + 1, 0);
+    
+    // Counting pass, then prefix sums, then fill
+    for (uint32_t c = 0; c < colony_count; ++c) {
+        for (uint8_t dir = 0; dir < 4; ++dir) {
+            uint32_t target = connection(c, dir);
+            if (target != NO_CONNECTION) reverse_offsets[target + 1]++;
+        }
+    }
+    for (uint32_t c = 0; c < colony_count; ++c) {
+        reverse_offsets[c + 1] += reverse_offsets[c];
+    }
+    
+    reverse_edges.resize(reverse_offsets[colony_count]);
+    std::vector<uint32_t> cursor(reverse_offsets.begin(), reverse_offsets.end() - 1);
+    for (uint32_t c = 0; c < colony_count; ++c) {
+        for (uint8_t dir = 0; dir < 4; ++dir) {
+            uint32_t target = connection(c, dir);
+            if (target != NO_CONNECTION) {
+                reverse_edges[cursor[target]++] = (c << 2) | dir;
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> ColonyGraph::traversalOrder(ColonyOrder order) const {
+    const uint32_t colony_count = size();
+    
+    // Tunnels are treated as undirected: outgoing connections plus incoming ones
+    auto for_each_neighbor = [&](uint32_t c, auto&& visit) {
+        for (uint32_t target : connections(c)) {
+            if (target != NO_CONNECTION) visit(target);
+        }
+        for (const uint32_t* edge = incomingBegin(c); edge != incomingEnd(c); ++edge) {
+            visit(*edge >> 2);
+        }
+    };
+    // Incoming tunnels are unbounded (any number of colonies can name the same neighbour)
+    std::vector<uint32_t> degree(colony_count, 0);
+    for (uint32_t c = 0; c < colony_count; ++c) {
+        degree[c] = static_cast<uint32_t>(std::bitset<4>(live_masks[c]).count()) + (reverse_offsets[c + 1] - reverse_offsets[c]);
+    }
+    
+    std::vector<uint32_t> sequence;  // Old IDs in their new order; doubles as the BFS queue
+    sequence.reserve(colony_count);
+    std::vector<uint8_t> visited(colony_count, 0);
+    std::vector<uint32_t> neighbors;  // Unvisited neighbours of the colony being expanded
+    
+    // Appends the component of start to sequence and returns the last colony reached.
+    // RCM visits each colony's unvisited neighbours in increasing degree order.
+    auto traverse = [&](uint32_t start, bool by_degree) {
+        size_t head = sequence.size();
+        visited[start] = 1;
+        sequence.push_back(start);
+        while (head < sequence.size()) {
+            uint32_t c = sequence[head++];
+            neighbors.clear();
+            for_each_neighbor(c, [&](uint32_t next) {
+                if (!visited[next]) {
+                    visited[next] = 1;
+                    neighbors.push_back(next);
+                }
+            });
+            if (by_degree) {
+                std::sort(neighbors.begin(), neighbors.end(), [&](uint32_t a, uint32_t b) {
+                    return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+                });
+            }
+            sequence.insert(sequence.end(), neighbors.begin(), neighbors.end());
+        }
+        return sequence.back();
+    };
+    
+    for (uint32_t c = 0; c < colony_count; ++c) {
+        if (visited[c]) continue;
+        if (order == ColonyOrder::BFS) {
+            traverse(c, false);
+            continue;
+        }
+        
+        // One probe BFS finds a far colony (pseudo-peripheral), then the real pass
+        // starts there. The probe's marks and entries are rolled back afterwards.
+        size_t component_begin = sequence.size();
+        uint32_t start = traverse(c, false);
+        for (size_t i = component_begin; i < sequence.size(); ++i) visited[sequence[i]] = 0;
+        sequence.resize(component_begin);
+        traverse(start, true);
+    }
+    
+    if (order == ColonyOrder::RCM) std::reverse(sequence.begin(), sequence.end());
+    return sequence;
+}
+
+void ColonyGraph::reorder(ColonyOrder order) {
+    if (order == ColonyOrder::FILE || size() == 0) return;
+    
+    const uint32_t colony_count = size();
+    std::vector<uint32_t> sequence = traversalOrder(order);
+    std::vector<uint32_t> new_id(colony_count);
+    for (uint32_t i = 0; i < colony_count; ++i) {
+        new_id[sequence[i]] = i;
+    }
+    
+    std::vector<Connections<uint32_t>> renumbered(colony_count);
+    std::vector<uint32_t> file_index(colony_count);
+    for (uint32_t i = 0; i < colony_count; ++i) {
+        Connections<uint32_t> colony = connections(sequence[i]);
+        for (uint32_t& target : colony) {
+            if (target != NO_CONNECTION) target = new_id[target];
+        }
+        renumbered[i] = colony;
+        file_index[i] = fileIndex(sequence[i]);  // Composes with any earlier reorder
+    }
+    assignConnections(std::move(renumbered));
+    file_index_of.swap(file_index);
+    
+    colony_at_file_index.resize(colony_count);
+    for (uint32_t i = 0; i < colony_count; ++i) {
+        colony_at_file_index[file_index_of[i]] = i;
+    }
+    
+    buildNeighborIndex();
+}
+
+Direction ColonyGraph::direction_to_enum(std::string_view direction) {
+    if (direction.empty()) return Direction::INVALID;
+    switch (direction[0]) {
+        case 'n': return Direction::NORTH;
+        case 's': return Direction::SOUTH;
+        case 'e': return Direction::EAST;
+        case 'w': return Direction::WEST;
+        default: return Direction::INVALID;  // Explicitly mark invalid directions
+    }
+}
@@ -0,0 +1,159 @@
+#include "ensemble.h"
+
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+EnsembleResult runEnsemble(std::shared_ptr<const ColonyGraph> graph, const EnsembleConfig& config) {
+    EnsembleResult result;
+    result.trials.resize(config.trials);
+    result.destroyed_counts.assign(graph->size(), 0);
+
+    // Trials are the unit of parallelism, so each simulation runs single-threaded
+    SimulationEngine engine = config.engine;
+    RngKind rng = config.rng;
+    if (engine == SimulationEngine::PARALLEL) {
+        engine = SimulationEngine::FUSED;
+        rng = RngKind::COUNTER;
+    }
+
+    const uint32_t workers = std::max(1u, std::min(config.threads, config.trials));
+    std::vector<std::unique_ptr<AntManiaSimulation>> sims;
+    std::vector<std::vector<uint32_t>> destroyed_counts(workers);
+    for (uint32_t w = 0; w < workers; ++w) {
+        auto sim = std::make_unique<AntManiaSimulation>();
+        sim->setSilent(true);
+        sim->setEngine(engine);
+        sim->setRng(rng);
+        sim->setFastForward(config.fast_forward);
+        sim->setVectorMoves(config.vector_moves);
+        sim->setMemoryOptions(config.memory);
+        sim->setGraph(graph);
+        sims.push_back(std::move(sim));
+        destroyed_counts[w].assign(graph->size(), 0);
+    }
+
+    std::atomic<uint32_t> next_trial{0};
+    auto worker_task = [&](uint32_t w) {
+        AntManiaSimulation& sim = *sims[w];
+        std::vector<uint32_t>& counts = destroyed_counts[w];
+        for (uint32_t t = next_trial.fetch_add(1); t < config.trials; t = next_trial.fetch_add(1)) {
+            sim.reset();
+            sim.setSeed(config.base_seed + t);
+            sim.createAnts(config.ants);
+            NullObserver none;
+            sim.run(none);
+
+            result.trials[t] = {config.base_seed + t, sim.getColoniesDestroyed(), sim.getIterations(),
+                                sim.getAntsRemaining(), sim.getFightPairs()};
+            if (sim.getColoniesDestroyed() > 0) {
+                for (uint32_t c = 0; c < graph->size(); ++c) {
+                    counts[c] += sim.isColonyDestroyed(c);
+                }
+            }
+        }
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (workers == 1) {
+        worker_task(0);
+    } else {
+        ThreadPool pool(workers);
+        pool.run(workers, worker_task);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    for (const auto& counts : destroyed_counts) {
+        for (uint32_t c = 0; c < graph->size(); ++c) {
+            result.destroyed_counts[c] += counts[c];
+        }
+    }
+    return result;
+}
+
+DistributionStats describe(std::vector<uint32_t> values) {
+    if (values.empty()) return {0, 0, 0, 0, 0, 0, 0};
+    std::sort(values.begin(), values.end());
+
+    double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    double variance = 0;
+    for (uint32_t v : values) variance += (v - mean) * (v - mean);
+    auto rank = [&](double pct) {
+        size_t index = static_cast<size_t>(std::ceil(pct / 100.0 * values.size()));
+        return values[std::clamp<size_t>(index, 1, values.size()) - 1];
+    };
+    return {mean, std::sqrt(variance / values.size()), values.front(), rank(50), rank(90), rank(99), values.back()};
+}
+
+void printEnsembleSummary(const EnsembleResult& result, const ColonyGraph& graph, std::ostream& os) {
+    static constexpr uint32_t HISTOGRAM_BUCKETS = 10;
+    static constexpr uint32_t HISTOGRAM_WIDTH = 50;
+    static constexpr uint32_t TOP_COLONIES = 10;
+
+    const uint32_t trials = static_cast<uint32_t>(result.trials.size());
+    std::vector<uint32_t> destroyed, iterations, survivors, fights;
+    for (const auto& trial : result.trials) {
+        destroyed.push_back(trial.colonies_destroyed);
+        iterations.push_back(trial.iterations);
+        survivors.push_back(trial.ants_remaining);
+        fights.push_back(trial.fight_pairs);
+    }
+
+    os << "\n=== Ensemble: " << trials << " trials in " << std::fixed << std::setprecision(1)
+       << result.elapsed_ms << " ms (" << (result.elapsed_ms > 0 ? trials / (result.elapsed_ms / 1000.0) : 0.0)
+       << " trials/s) ===" << std::endl;
+    os << std::left << std::setw(22) << "Statistic" << std::setw(12) << "Mean" << std::setw(10) << "Stddev"
+       << std::setw(10) << "Min" << std::setw(10) << "P50" << std::setw(10) << "P90"
+       << std::setw(10) << "P99" << "Max" << std::endl;
+    os << std::string(94, '-') << std::endl;
+
+    auto row = [&](const char* label, const std::vector<uint32_t>& values) {
+        DistributionStats stats = describe(values);
+        os << std::left << std::setw(22) << label << std::setprecision(2) << std::setw(12) << stats.mean
+           << std::setw(10) << stats.stddev << std::setw(10) << stats.min << std::setw(10) << stats.p50
+           << std::setw(10) << stats.p90 << std::setw(10) << stats.p99 << stats.max << std::endl;
+    };
+    row("Colonies destroyed", destroyed);
+    row("Iterations", iterations);
+    row("Ants remaining", survivors);
+    row("Fight pairs", fights);
+
+    if (trials == 0) return;
+
+    // Histogram of colonies destroyed per trial
+    DistributionStats stats = describe(destroyed);
+    uint32_t span = stats.max - stats.min + 1;
+    uint32_t bucket_width = (span + HISTOGRAM_BUCKETS - 1) / HISTOGRAM_BUCKETS;
+    std::vector<uint32_t> buckets((span + bucket_width - 1) / bucket_width, 0);
+    for (uint32_t value : destroyed) {
+        buckets[(value - stats.min) / bucket_width]++;
+    }
+    uint32_t tallest = *std::max_element(buckets.begin(), buckets.end());
+
+    os << "\nColonies destroyed per trial:" << std::endl;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        uint32_t low = stats.min + static_cast<uint32_t>(b) * bucket_width;
+        std::string range = std::to_string(low) + "-" + std::to_string(low + bucket_width - 1);
+        os << std::right << std::setw(14) << range << " | " << std::left << std::setw(HISTOGRAM_WIDTH)
+           << std::string(buckets[b] * HISTOGRAM_WIDTH / tallest, '#') << " " << buckets[b] << std::endl;
+    }
+
+    // Colonies most likely to be destroyed
+    std::vector<uint32_t> order(result.destroyed_counts.size());
+    std::iota(order.begin(), order.end(), 0u);
+    size_t shown = std::min<size_t>(TOP_COLONIES, order.size());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&](uint32_t a, uint32_t b) {
+        return result.destroyed_counts[a] != result.destroyed_counts[b]
+                   ? result.destroyed_counts[a] > result.destroyed_counts[b]
+                   : graph.fileIndex(a) < graph.fileIndex(b);
+    });
+
+    os << "\nMost frequently destroyed colonies:" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        uint32_t c = order[i];
+        os << "  " << std::left << std::setw(24) << graph.name(c) << std::setprecision(1)
+           << 100.0 * result.destroyed_counts[c] / trials << "%" << std::endl;
+    }
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include "map_generator.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <output_file> <num_colonies> [--topology grid|random]"
+                  << " [--missing-edges RATIO] [--seed N] [--shuffle]" << std::endl;
+        std::cout << "Example: " << argv[0] << " grid_10m.txt 10000000 --missing-edges 0.05" << std::endl;
+        return 1;
+    }
+
+    std::string output_file = argv[1];
+    MapGeneratorConfig config;
+    config.colonies = std::stoul(argv[2]);
+
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--topology" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "grid") {
+                config.topology = MapTopology::GRID;
+            } else if (name == "random") {
+                config.topology = MapTopology::RANDOM;
+            } else {
+                std::cerr << "Error: Unknown topology " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--missing-edges" && i + 1 < argc) {
+            config.missing_edge_ratio = std::stod(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--shuffle") {
+            // Colony IDs follow file order, so this destroys the grid's locality
+            config.shuffle_lines = true;
+        } else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!generateMap(config, output_file)) {
+        std::cerr << "Error: Could not write " << output_file << std::endl;
+        return 1;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "Generated " << config.colonies << " colonies in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+              << " ms -> " << output_file << std::endl;
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "huge_page_arena.h"
+
+#include <fstream>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t SMALL_PAGE_SIZE = 4096;
+constexpr int MPOL_PREFERRED_MODE = 1;  // MPOL_PREFERRED in <linux/mempolicy.h>
+
+// Prefers the NUMA node of the calling thread. Uses the raw syscalls, so libnuma is not needed.
+void bindToLocalNode(void* base, size_t bytes) {
+#if defined(SYS_getcpu) && defined(SYS_mbind)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= 64) return;
+    unsigned long nodemask = 1ul << node;
+    syscall(SYS_mbind, base, bytes, MPOL_PREFERRED_MODE, &nodemask, sizeof(nodemask) * 8, 0);
+#else
+    (void)base;
+    (void)bytes;
+#endif
+}
+
+void prefaultPages(char* base, size_t bytes, size_t page_size) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(base, bytes, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    // Older kernels: one write per page (the mapping is zero-filled, so zero is a no-op value)
+    for (size_t offset = 0; offset < bytes; offset += page_size) {
+        static_cast<volatile char*>(base)[offset] = 0;
+    }
+}
+
+// Anonymous mapping of `bytes` (a multiple of HUGE_PAGE_SIZE) starting on a huge page boundary
+char* mapAligned(size_t bytes) {
+    const size_t slack = HugePageArena::HUGE_PAGE_SIZE;
+    void* raw = mmap(nullptr, bytes + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (start + slack - 1) & ~(uintptr_t{slack} - 1);
+    if (aligned > start) munmap(raw, aligned - start);
+    const size_t tail = start + bytes + slack - (aligned + bytes);
+    if (tail > 0) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    return reinterpret_cast<char*>(aligned);
+}
+
+}  // namespace
+
+HugePageArena::HugePageArena(const MemoryOptions& memory_options) : options(memory_options) {}
+
+HugePageArena::~HugePageArena() {
+    for (const Block& block : blocks) {
+        munmap(block.base, block.size);
+    }
+}
+
+bool HugePageArena::mapBlock(size_t bytes) {
+    const size_t size = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    char* base = nullptr;
+    PageBacking backing = PageBacking::NORMAL;
+
+    // The hugetlb pool is usually empty unless the administrator reserved pages
+#if defined(MAP_HUGETLB)
+    if (options.huge_pages == HugePages::EXPLICIT) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= 21 << MAP_HUGE_SHIFT;  // 2 MB pages
+#endif
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (mapped != MAP_FAILED) {
+            base = static_cast<char*>(mapped);
+            backing = PageBacking::EXPLICIT;
+        }
+    }
+#endif
+
+    if (!base) {
+        base = mapAligned(size);
+        if (!base) return false;
+#ifdef MADV_HUGEPAGE
+        // Fails where THP is disabled; the block is still usable on normal pages
+        if (madvise(base, size, MADV_HUGEPAGE) == 0) backing = PageBacking::TRANSPARENT;
+#endif
+    }
+
+    // Policy must be set before the first touch places any page
+    if (options.numa_local) bindToLocalNode(base, size);
+    if (options.prefault) prefaultPages(base, size, backing == PageBacking::EXPLICIT ? HUGE_PAGE_SIZE : SMALL_PAGE_SIZE);
+
+    blocks.push_back({base, size, 0, backing});
+    return true;
+}
+
+void HugePageArena::reserve(size_t bytes) {
+    // Below one huge page there is nothing to gain over the heap
+    if (options.huge_pages == HugePages::OFF || bytes < HUGE_PAGE_SIZE) return;
+    if (!blocks.empty() && blocks.back().size - blocks.back().used >= bytes) return;
+    mapBlock(bytes);
+}
+
+void* HugePageArena::allocate(size_t bytes) {
+    const size_t rounded = roundUp(bytes);
+    if (!blocks.empty() && rounded > 0) {
+        Block& block = blocks.back();
+        if (block.size - block.used >= rounded) {
+            void* pointer = block.base + block.used;
+            block.used += rounded;
+            return pointer;
+        }
+    }
+    return ::operator new(bytes);
+}
+
+void HugePageArena::deallocate(void* pointer, size_t bytes) noexcept {
+    const char* p = static_cast<const char*>(pointer);
+    for (Block& block : blocks) {
+        if (p < block.base || p >= block.base + block.size) continue;
+        // Only the most recent allocation of a block can be handed back
+        if (p + roundUp(bytes) == block.base + block.used) block.used -= roundUp(bytes);
+        return;
+    }
+    ::operator delete(pointer);
+}
+
+bool HugePageArena::owns(const void* pointer) const {
+    const char* p = static_cast<const char*>(pointer);
+    for (const Block& block : blocks) {
+        if (p >= block.base && p < block.base + block.size) return true;
+    }
+    return false;
+}
+
+ArenaStats HugePageArena::stats() const {
+    ArenaStats stats;
+    for (const Block& block : blocks) {
+        stats.blocks++;
+        stats.mapped_bytes += block.size;
+        stats.used_bytes += block.used;
+        if (block.backing == PageBacking::EXPLICIT) stats.explicit_bytes += block.size;
+        if (block.backing == PageBacking::TRANSPARENT) stats.transparent_bytes += block.size;
+    }
+    return stats;
+}
+
+size_t HugePageArena::residentHugeBytes() const {
+    size_t total = 0;
+    bool any_transparent = false;
+    for (const Block& block : blocks) {
+        if (block.backing == PageBacking::EXPLICIT) total += block.size;
+        if (block.backing == PageBacking::TRANSPARENT) any_transparent = true;
+    }
+    if (!any_transparent) return total;
+
+    // Transparent blocks only get huge pages the kernel actually managed to assemble
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool in_block = false;
+    while (std::getline(smaps, line)) {
+        size_t dash = line.find('-');
+        if (dash != std::string::npos && dash > 0 && line.find(' ') > dash &&
+            line.find_first_not_of("0123456789abcdef") == dash) {
+            uintptr_t start = std::stoull(line.substr(0, dash), nullptr, 16);
+            in_block = false;
+            for (const Block& block : blocks) {
+                uintptr_t base = reinterpret_cast<uintptr_t>(block.base);
+                if (block.backing == PageBacking::TRANSPARENT && start >= base && start < base + block.size) in_block = true;
+            }
+        } else if (in_block && line.compare(0, 14, "AnonHugePages:") == 0) {
+            total += std::stoull(line.substr(14)) * 1024;
+        }
+    }
+    return total;
+}
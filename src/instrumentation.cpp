@@ -0,0 +1,240 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = {"move", "collide", "maintenance"};
+static const char* const PERF_EVENT_NAMES[PERF_EVENT_COUNT] = {"cycles", "cache_misses", "branch_misses", "dtlb_misses"};
+
+PerfCounters::PerfCounters() : active(false) {
+    for (int& fd : fds) fd = -1;
+}
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+bool PerfCounters::open() {
+    close();
+#ifdef __linux__
+    static constexpr uint32_t EVENT_TYPES[PERF_EVENT_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    static constexpr uint64_t EVENT_CONFIGS[PERF_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENT_TYPES[i];
+        attr.config = EVENT_CONFIGS[i];
+        attr.disabled = (i == 0);  // The group leader starts the whole group
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        // Calling thread only, any CPU
+        int group_fd = (i == 0) ? -1 : fds[0];
+        fds[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+        if (fds[i] < 0) {
+            close();
+            return false;
+        }
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    active = true;
+#endif
+    return active;
+}
+
+void PerfCounters::close() {
+#ifdef __linux__
+    for (int& fd : fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+#endif
+    active = false;
+}
+
+void PerfCounters::read(uint64_t (&values)[PERF_EVENT_COUNT]) const {
+    std::fill(values, values + PERF_EVENT_COUNT, 0);
+#ifdef __linux__
+    if (!active) return;
+
+    // PERF_FORMAT_GROUP layout: { nr, value[nr] }
+    uint64_t buffer[1 + PERF_EVENT_COUNT];
+    if (::read(fds[0], buffer, sizeof(buffer)) == static_cast<ssize_t>(sizeof(buffer))) {
+        std::copy(buffer + 1, buffer + 1 + PERF_EVENT_COUNT, values);
+    }
+#endif
+}
+
+Instrumentation::Instrumentation(size_t capacity)
+    : ring(std::max<size_t>(capacity, 1))
+    , recorded(0)
+    , current{}
+    , current_phase(Phase::NONE)
+    , phase_perf_start{}
+    , steps_at_start(0)
+    , destroyed_at_start(0)
+    , total_ns{}
+    , total_perf{}
+    , total_live(0)
+    , total_moved(0)
+    , total_touched(0)
+    , total_destroyed(0)
+    , perf_requested(false) {}
+
+void Instrumentation::start() {
+    recorded = 0;
+    current = IterationSample{};
+    current_phase = Phase::NONE;
+    std::fill(std::begin(total_ns), std::end(total_ns), 0);
+    for (auto& phase : total_perf) std::fill(std::begin(phase), std::end(phase), 0);
+    total_live = total_moved = total_touched = total_destroyed = 0;
+
+    if (perf_requested) perf.open();
+}
+
+void Instrumentation::stop() {
+    closePhase();
+    perf.close();
+}
+
+void Instrumentation::closePhase() {
+    if (current_phase == Phase::NONE) return;
+
+    const size_t p = static_cast<size_t>(current_phase);
+    auto now = Clock::now();
+    current.phase_ns[p] += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_start).count());
+
+    if (perf.isActive()) {
+        uint64_t values[PERF_EVENT_COUNT];
+        perf.read(values);
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            current.perf[p][e] += values[e] - phase_perf_start[e];
+        }
+    }
+    current_phase = Phase::NONE;
+}
+
+void Instrumentation::beginIteration(uint32_t iteration, uint32_t live_ants, uint64_t ant_steps,
+                                     uint32_t colonies_destroyed) {
+    current = IterationSample{};
+    current.iteration = iteration;
+    current.live_ants = live_ants;
+    steps_at_start = ant_steps;
+    destroyed_at_start = colonies_destroyed;
+}
+
+void Instrumentation::enterPhase(Phase phase) {
+    closePhase();
+    current_phase = phase;
+    if (perf.isActive()) perf.read(phase_perf_start);
+    phase_start = Clock::now();
+}
+
+void Instrumentation::endIteration(uint64_t ant_steps, uint32_t colonies_destroyed) {
+    closePhase();
+    current.moved = static_cast<uint32_t>(ant_steps - steps_at_start);
+    current.destroyed = colonies_destroyed - destroyed_at_start;
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        total_ns[p] += current.phase_ns[p];
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            total_perf[p][e] += current.perf[p][e];
+        }
+    }
+    total_live += current.live_ants;
+    total_moved += current.moved;
+    total_touched += current.touched;
+    total_destroyed += current.destroyed;
+
+    ring[recorded % ring.size()] = current;
+    recorded++;
+}
+
+size_t Instrumentation::size() const {
+    return static_cast<size_t>(std::min<uint64_t>(recorded, ring.size()));
+}
+
+const IterationSample& Instrumentation::sample(size_t i) const {
+    // Once the ring has wrapped, the oldest retained sample sits at the write position
+    size_t first = recorded > ring.size() ? static_cast<size_t>(recorded % ring.size()) : 0;
+    return ring[(first + i) % ring.size()];
+}
+
+void Instrumentation::printSummary(std::ostream& os) const {
+    const double iterations = recorded > 0 ? static_cast<double>(recorded) : 1.0;
+    uint64_t all_ns = 0;
+    for (uint64_t ns : total_ns) all_ns += ns;
+
+    os << "\n=== Instrumentation (" << recorded << " iterations, last " << size() << " traced) ===" << std::endl;
+    os << std::left << std::setw(13) << "Phase" << std::setw(12) << "Total (ms)" << std::setw(8) << "Share"
+       << std::setw(12) << "ns/iter";
+    if (perf.isActive()) {
+        os << std::setw(16) << "Cycles" << std::setw(14) << "Cache misses" << std::setw(15) << "Branch misses"
+           << "dTLB misses";
+    }
+    os << std::endl;
+    os << std::string(perf.isActive() ? 103 : 45, '-') << std::endl;
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        os << std::left << std::setw(13) << PHASE_NAMES[p] << std::fixed << std::setprecision(3)
+           << std::setw(12) << total_ns[p] / 1e6 << std::setprecision(1)
+           << std::setw(8) << (all_ns > 0 ? 100.0 * total_ns[p] / all_ns : 0.0)
+           << std::setw(12) << total_ns[p] / iterations;
+        if (perf.isActive()) {
+            os << std::setw(16) << total_perf[p][0] << std::setw(14) << total_perf[p][1] << std::setw(15)
+               << total_perf[p][2] << total_perf[p][3];
+        }
+        os << std::endl;
+    }
+
+    os << std::setprecision(1) << "Per iteration: " << total_live / iterations << " live ants, "
+       << total_moved / iterations << " moved, " << total_touched / iterations << " colonies touched, "
+       << total_destroyed << " colonies destroyed in total" << std::endl;
+    if (perf_requested && !perf.isActive()) {
+        os << "Hardware counters unavailable (perf_event_open failed)" << std::endl;
+    }
+}
+
+void Instrumentation::writeCsv(std::ostream& os) const {
+    os << "iteration,live_ants,moved,touched,destroyed";
+    for (const char* phase : PHASE_NAMES) os << ',' << phase << "_ns";
+    for (const char* phase : PHASE_NAMES) {
+        for (const char* event : PERF_EVENT_NAMES) os << ',' << phase << '_' << event;
+    }
+    os << '\n';
+
+    for (size_t i = 0; i < size(); ++i) {
+        const IterationSample& s = sample(i);
+        os << s.iteration << ',' << s.live_ants << ',' << s.moved << ',' << s.touched << ',' << s.destroyed;
+        for (uint64_t ns : s.phase_ns) os << ',' << ns;
+        for (const auto& phase : s.perf) {
+            for (uint64_t value : phase) os << ',' << value;
+        }
+        os << '\n';
+    }
+}
+
+bool Instrumentation::writeCsv(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) return false;
+    writeCsv(out);
+    return static_cast<bool>(out);
+}
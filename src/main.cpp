@@ -1,8 +1,28 @@
 #include "ant_mania.h"
+#include "ensemble.h"
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <map_file> <num_ants>" << std::endl;
+    // Compile mode: parse a text map once and save it in the binary format
+    if (argc == 4 && std::string(argv[1]) == "--compile-map") {
+        AntManiaSimulation simulation;
+        if (!simulation.loadMap(argv[2]) || !simulation.compileMap(argv[3])) {
+            return 1;
+        }
+        std::cout << "Compiled " << argv[2] << " -> " << argv[3] << std::endl;
+        return 0;
+    }
+    
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <map_file> <num_ants> [--engine two-pass|fused|parallel] [--threads N]"
+                  << " [--rng xoshiro|mt19937|counter] [--seed N] [--no-fast-forward] [--no-simd] [--generic-policy] [--reorder file|bfs|rcm] [--load-threads N]"
+                  << " [--huge-pages off|thp|explicit] [--prefault] [--numa-local]"
+                  << " [--quiet] [--async-output] [--ensemble TRIALS]"
+                  << " [--checkpoint FILE] [--checkpoint-every N] [--resume FILE]"
+#ifdef ANT_MANIA_INSTRUMENT
+                  << " [--trace FILE] [--perf-counters]"
+#endif
+                  << std::endl;
+        std::cout << "       " << argv[0] << " --compile-map <map_file> <binary_map_file>" << std::endl;
         std::cout << "Example: " << argv[0] << " hiveum_map_small.txt 100" << std::endl;
         return 1;
     }
@@ -16,18 +36,168 @@ int main(int argc, char* argv[]) {
     }
     
     AntManiaSimulation simulation;
+    std::string trace_file;
+    uint32_t ensemble_trials = 0;
+    bool seed_given = false;
+    std::string checkpoint_file;
+    std::string resume_file;
+    uint32_t checkpoint_every = 1000;
+    MemoryOptions memory_options;
+    
+    // Optional flags
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--engine" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "two-pass") {
+                simulation.setEngine(SimulationEngine::TWO_PASS);
+            } else if (name == "fused") {
+                simulation.setEngine(SimulationEngine::FUSED);
+            } else if (name == "parallel") {
+                simulation.setEngine(SimulationEngine::PARALLEL);
+            } else {
+                std::cerr << "Error: Unknown engine " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--rng" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "xoshiro") {
+                simulation.setRng(RngKind::XOSHIRO);
+            } else if (name == "mt19937") {
+                simulation.setRng(RngKind::MT19937);
+            } else if (name == "counter") {
+                simulation.setRng(RngKind::COUNTER);
+            } else {
+                std::cerr << "Error: Unknown RNG " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--reorder" && i + 1 < argc) {
+            // Renumbers colonies for locality; the output is unchanged
+            std::string name = argv[++i];
+            if (name == "file") {
+                simulation.setColonyOrder(ColonyOrder::FILE);
+            } else if (name == "bfs") {
+                simulation.setColonyOrder(ColonyOrder::BFS);
+            } else if (name == "rcm") {
+                simulation.setColonyOrder(ColonyOrder::RCM);
+            } else {
+                std::cerr << "Error: Unknown colony order " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--huge-pages" && i + 1 < argc) {
+            // Page backing of the map tables and run state; explicit falls back to thp, thp to normal pages
+            std::string name = argv[++i];
+            if (name == "off") {
+                memory_options.huge_pages = HugePages::OFF;
+            } else if (name == "thp") {
+                memory_options.huge_pages = HugePages::TRANSPARENT;
+            } else if (name == "explicit") {
+                memory_options.huge_pages = HugePages::EXPLICIT;
+            } else {
+                std::cerr << "Error: Unknown huge page mode " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--prefault") {
+            // Faults the arenas in up front instead of during the first iterations
+            memory_options.prefault = true;
+        } else if (arg == "--numa-local") {
+            memory_options.numa_local = true;
+        } else if (arg == "--load-threads" && i + 1 < argc) {
+            // Large text maps are parsed in parallel; IDs are the same as a sequential load
+            simulation.setLoaderThreads(std::stoul(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            simulation.setThreads(std::stoul(argv[++i]));
+        } else if (arg == "--quiet") {
+            // Destruction messages are counted but not printed
+            simulation.setQuiet(true);
+        } else if (arg == "--async-output") {
+            simulation.setAsyncOutput(true);
+        } else if (arg == "--no-fast-forward") {
+            simulation.setFastForward(false);
+        } else if (arg == "--no-simd") {
+            // Scalar move loop even on AVX2 machines (same output)
+            simulation.setVectorMoves(false);
+        } else if (arg == "--generic-policy") {
+            // Runtime-dispatched iteration path instead of the specialized one (same output)
+            simulation.setSpecialized(false);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            // Replays a previous run exactly (seed is printed after ant creation)
+            simulation.setSeed(std::stoull(argv[++i]));
+            seed_given = true;
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            // Rewritten every --checkpoint-every iterations, in the background
+            checkpoint_file = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            checkpoint_every = std::max(1ul, std::stoul(argv[++i]));
+        } else if (arg == "--resume" && i + 1 < argc) {
+            // Continues a checkpointed run on the same map; num_ants is ignored
+            resume_file = argv[++i];
+        } else if (arg == "--ensemble" && i + 1 < argc) {
+            // Many independent trials over one loaded map; prints statistics, not worlds
+            ensemble_trials = std::stoul(argv[++i]);
+#ifdef ANT_MANIA_INSTRUMENT
+        } else if (arg == "--trace" && i + 1 < argc) {
+            // Per-iteration CSV trace of the last iterations
+            trace_file = argv[++i];
+        } else if (arg == "--perf-counters") {
+            simulation.getInstrumentation().setPerfCounters(true);
+#endif
+        } else {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
     
     // Load map
+    simulation.setMemoryOptions(memory_options);
     if (!simulation.loadMap(map_file)) {
         return 1;
     }
     
+    if (ensemble_trials > 0) {
+        EnsembleConfig config;
+        config.trials = ensemble_trials;
+        config.ants = num_ants;
+        config.base_seed = seed_given ? simulation.getSeed() : std::random_device{}();
+        config.threads = simulation.getThreads();
+        config.engine = simulation.getEngine();
+        config.rng = simulation.getRng();
+        config.fast_forward = simulation.getFastForward();
+        config.vector_moves = simulation.getVectorMoves();
+        config.memory = simulation.getMemoryOptions();
+        
+        std::cout << "Running " << ensemble_trials << " trials of " << num_ants << " ants on "
+                  << config.threads << " threads (seeds " << config.base_seed << "..)" << std::endl;
+        EnsembleResult result = runEnsemble(simulation.getGraph(), config);
+        printEnsembleSummary(result, *simulation.getGraph(), std::cout);
+        return 0;
+    }
+    
     // Create ants
-    simulation.createAnts(num_ants);
+    if (!resume_file.empty()) {
+        if (!simulation.restoreCheckpoint(resume_file)) {
+            return 1;
+        }
+        std::cout << "Resumed " << resume_file << " at iteration " << simulation.getIterations()
+                  << " (seed " << simulation.getSeed() << ")" << std::endl;
+    } else {
+        simulation.createAnts(num_ants);
+    }
+    if (!checkpoint_file.empty()) {
+        simulation.setCheckpoint(checkpoint_file, checkpoint_every);
+    }
     
     // Run simulation
     simulation.runSimulation();
     
+#ifdef ANT_MANIA_INSTRUMENT
+    // Diagnostics go to stderr so stdout stays the simulation's own output
+    simulation.getInstrumentation().printSummary(std::cerr);
+    if (!trace_file.empty() && !simulation.getInstrumentation().writeCsv(trace_file)) {
+        std::cerr << "Error: Could not write " << trace_file << std::endl;
+    }
+#endif
+    
     // Print results
     simulation.printStatistics();
     simulation.printRemainingWorld();
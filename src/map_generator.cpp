@@ -0,0 +1,130 @@
+#include "map_generator.h"
+#include "fast_rng.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+static constexpr uint32_t NO_NEIGHBOR = UINT32_MAX;
+
+std::string colonyNameFor(uint32_t index) {
+    std::string name = "Col";
+    do {
+        name += static_cast<char>('a' + index % 26);
+        index /= 26;
+    } while (index > 0);
+    return name;
+}
+
+namespace {
+
+// Neighbours of every colony in north, south, east, west order, computed on demand
+class Topology {
+private:
+    MapGeneratorConfig config;
+    uint32_t width;
+    uint32_t drop_threshold;  // A tunnel is dropped when its hash falls below this
+
+    // RANDOM: path order per axis and each colony's position in it
+    std::vector<uint32_t> path[2];
+    std::vector<uint32_t> position[2];
+
+    // Tunnels are identified by (axis, index of their first endpoint), so both ends agree
+    bool keep(uint32_t axis, uint32_t edge) const {
+        return drop_threshold == 0 || counterDraw(config.seed, axis, edge) >= drop_threshold;
+    }
+
+public:
+    explicit Topology(const MapGeneratorConfig& cfg) : config(cfg) {
+        width = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(cfg.colonies)))));
+        double ratio = std::clamp(cfg.missing_edge_ratio, 0.0, 1.0);
+        drop_threshold = static_cast<uint32_t>(std::min(ratio * 4294967296.0, 4294967295.0));
+
+        if (cfg.topology == MapTopology::RANDOM) {
+            Xoshiro256 rng(cfg.seed);
+            for (int axis = 0; axis < 2; ++axis) {
+                path[axis].resize(cfg.colonies);
+                std::iota(path[axis].begin(), path[axis].end(), 0u);
+                for (uint32_t i = cfg.colonies; i > 1; --i) {
+                    std::swap(path[axis][i - 1], path[axis][boundedDraw(static_cast<uint32_t>(rng()), i)]);
+                }
+                position[axis].resize(cfg.colonies);
+                for (uint32_t i = 0; i < cfg.colonies; ++i) {
+                    position[axis][path[axis][i]] = i;
+                }
+            }
+        }
+    }
+
+    std::array<uint32_t, 4> neighbors(uint32_t c) const {
+        std::array<uint32_t, 4> result{NO_NEIGHBOR, NO_NEIGHBOR, NO_NEIGHBOR, NO_NEIGHBOR};
+        const uint32_t n = config.colonies;
+
+        if (config.topology == MapTopology::GRID) {
+            // Last row may be partial
+            uint32_t x = c % width;
+            if (c >= width && keep(0, c - width)) result[0] = c - width;
+            if (c + width < n && keep(0, c)) result[1] = c + width;
+            if (x + 1 < width && c + 1 < n && keep(1, c)) result[2] = c + 1;
+            if (x > 0 && keep(1, c - 1)) result[3] = c - 1;
+        } else {
+            // Along each path, the later colony lies north (or east) of the earlier one
+            for (uint32_t axis = 0; axis < 2; ++axis) {
+                uint32_t pos = position[axis][c];
+                if (pos + 1 < n && keep(axis, pos)) result[axis * 2] = path[axis][pos + 1];
+                if (pos > 0 && keep(axis, pos - 1)) result[axis * 2 + 1] = path[axis][pos - 1];
+            }
+        }
+        return result;
+    }
+};
+
+}  // namespace
+
+bool generateMap(const MapGeneratorConfig& config, std::ostream& out) {
+    static constexpr const char* DIRECTIONS[4] = {" north=", " south=", " east=", " west="};
+    static constexpr size_t FLUSH_BYTES = 1 << 20;
+
+    Topology topology(config);
+
+    std::vector<uint32_t> order;
+    if (config.shuffle_lines) {
+        order.resize(config.colonies);
+        std::iota(order.begin(), order.end(), 0u);
+        Xoshiro256 rng(config.seed ^ 0x5EED5EED5EED5EEDULL);
+        for (uint32_t i = config.colonies; i > 1; --i) {
+            std::swap(order[i - 1], order[boundedDraw(static_cast<uint32_t>(rng()), i)]);
+        }
+    }
+
+    // Lines are assembled in a large buffer and written in chunks
+    std::string buffer;
+    buffer.reserve(FLUSH_BYTES + 256);
+    for (uint32_t i = 0; i < config.colonies; ++i) {
+        uint32_t c = config.shuffle_lines ? order[i] : i;
+        buffer += colonyNameFor(c);
+        std::array<uint32_t, 4> next = topology.neighbors(c);
+        for (int dir = 0; dir < 4; ++dir) {
+            if (next[dir] == NO_NEIGHBOR) continue;
+            buffer += DIRECTIONS[dir];
+            buffer += colonyNameFor(next[dir]);
+        }
+        buffer += '\n';
+
+        if (buffer.size() >= FLUSH_BYTES) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+bool generateMap(const MapGeneratorConfig& config, const std::string& filename) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    return generateMap(config, out);
+}
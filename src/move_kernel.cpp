@@ -0,0 +1,198 @@
+#include "move_kernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ANT_MANIA_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+bool moveKernelAvailable() {
+#ifdef ANT_MANIA_AVX2_KERNEL
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#ifdef ANT_MANIA_AVX2_KERNEL
+
+#define AVX2_TARGET __attribute__((target("avx2,popcnt")))
+
+namespace {
+
+// nth[mask * 4 + k] = k-th live direction of mask, widened for a 32-bit gather
+struct DirectionTable {
+    int32_t nth[64];
+};
+
+constexpr DirectionTable makeDirectionTable() {
+    DirectionTable table{};
+    for (int mask = 0; mask < 16; ++mask) {
+        int count = 0;
+        for (int dir = 0; dir < 4; ++dir) {
+            if (mask & (1 << dir)) table.nth[mask * 4 + count++] = dir;
+        }
+    }
+    return table;
+}
+
+constexpr DirectionTable DIRECTION_TABLE = makeDirectionTable();
+
+// Low 64 bits of a * b per 64-bit lane; AVX2 only multiplies 32 x 32 -> 64
+AVX2_TARGET inline __m256i mul64(__m256i a, __m256i b) {
+    __m256i low = _mm256_mul_epu32(a, b);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                     _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+
+// counterDraw() for four (stream, counter) pairs; the draw is left in the high half of each lane
+AVX2_TARGET inline __m256i counterDraw4(__m256i seed, __m256i streams, __m256i counters) {
+    __m256i key = _mm256_or_si256(_mm256_slli_epi64(streams, 32), counters);
+    __m256i z = _mm256_xor_si256(seed, mul64(key, _mm256_set1_epi64x(static_cast<long long>(0xD1B54A32D192ED03ULL))));
+    z = _mm256_add_epi64(z, _mm256_set1_epi64x(static_cast<long long>(0x9E3779B97F4A7C15ULL)));
+    z = mul64(_mm256_xor_si256(z, _mm256_srli_epi64(z, 30)), _mm256_set1_epi64x(static_cast<long long>(0xBF58476D1CE4E5B9ULL)));
+    z = mul64(_mm256_xor_si256(z, _mm256_srli_epi64(z, 27)), _mm256_set1_epi64x(static_cast<long long>(0x94D049BB133111EBULL)));
+    return _mm256_xor_si256(z, _mm256_srli_epi64(z, 31));
+}
+
+// Eight counter draws, one per ant, in ant order
+AVX2_TARGET inline __m256i counterDraw8(__m256i seed, __m256i ant_ids, __m256i move_counts) {
+    __m256i low = counterDraw4(seed, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(ant_ids)),
+                               _mm256_cvtepu32_epi64(_mm256_castsi256_si128(move_counts)));
+    __m256i high = counterDraw4(seed, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(ant_ids, 1)),
+                                _mm256_cvtepu32_epi64(_mm256_extracti128_si256(move_counts, 1)));
+    const __m256i odd = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7);
+    return _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(low, odd),
+                                     _mm256_permutevar8x32_epi32(high, odd), 0x20);
+}
+
+template <RngKind KIND, typename ColonyId>
+AVX2_TARGET inline uint32_t moveKernel(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally) {
+    static_assert(KIND != RngKind::MT19937, "mt19937 draws are sequential");
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i all_ones = _mm256_set1_epi32(-1);  // Also DEAD_ANT
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    const __m256i count_table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i seed = _mm256_set1_epi64x(static_cast<long long>(batch.seed));
+    const __m128i max_moves = _mm_set1_epi16(static_cast<short>(batch.max_moves));
+    const int* live_words = reinterpret_cast<const int*>(batch.live_masks);
+    const int* rows = static_cast<const int*>(batch.connections);
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i colony = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.colony_ids + i));
+        __m256i alive = _mm256_andnot_si256(_mm256_cmpeq_epi32(colony, all_ones), all_ones);
+        if (_mm256_testz_si256(alive, alive)) continue;
+
+        // Live masks: gather the aligned 4-byte word holding each mask, then shift its byte down
+        __m256i words = _mm256_mask_i32gather_epi32(zero, live_words, _mm256_srli_epi32(colony, 2), alive, 4);
+        __m256i mask = _mm256_and_si256(
+            _mm256_srlv_epi32(words, _mm256_slli_epi32(_mm256_and_si256(colony, three), 3)), low_byte);
+
+        // Upper bytes of each lane are zero and look up count[0] = 0
+        __m256i count = _mm256_shuffle_epi8(count_table, mask);
+        __m256i no_exit = _mm256_cmpeq_epi32(count, zero);
+        __m256i moving = _mm256_andnot_si256(no_exit, alive);
+        __m256i trapped = _mm256_and_si256(no_exit, alive);
+
+        __m128i counts16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.move_counts + i));
+        __m256i random;
+        if constexpr (KIND == RngKind::XOSHIRO) {
+            random = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.random + i));
+        } else {
+            __m256i ant_ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.ant_ids + i));
+            random = counterDraw8(seed, ant_ids, _mm256_cvtepu16_epi32(counts16));
+        }
+
+        // boundedDraw: (random * count) >> 32, even and odd lanes separately
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(random, count), 32);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(random, 32), _mm256_srli_epi64(count, 32));
+        __m256i choice = _mm256_blend_epi32(even, odd, 0xAA);
+
+        __m256i dir = _mm256_mask_i32gather_epi32(zero, DIRECTION_TABLE.nth,
+                                                  _mm256_add_epi32(_mm256_slli_epi32(mask, 2), choice), moving, 4);
+        __m256i slot = _mm256_add_epi32(_mm256_slli_epi32(colony, 2), dir);
+        __m256i next;
+        if constexpr (sizeof(ColonyId) == sizeof(uint32_t)) {
+            next = _mm256_mask_i32gather_epi32(zero, rows, slot, moving, 4);
+        } else {
+            // 16-bit rows: gather the aligned pair of IDs and keep the right half
+            __m256i pair = _mm256_mask_i32gather_epi32(zero, rows, _mm256_srli_epi32(slot, 1), moving, 4);
+            __m256i half = _mm256_slli_epi32(_mm256_and_si256(slot, _mm256_set1_epi32(1)), 4);
+            next = _mm256_and_si256(_mm256_srlv_epi32(pair, half), _mm256_set1_epi32(0xFFFF));
+        }
+
+        if (batch.trapped && !_mm256_testz_si256(trapped, trapped)) {
+            alignas(32) uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), colony);
+            uint32_t bits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(trapped)));
+            TrappedAnt* out = batch.trapped + tally.trapped;
+            for (; bits != 0; bits &= bits - 1) {
+                uint32_t lane = static_cast<uint32_t>(__builtin_ctz(bits));
+                *out++ = {batch.ant_ids[i + lane], lanes[lane], batch.move_counts[i + lane]};
+            }
+        }
+
+        // Movers take their destination; trapped ants become DEAD_ANT
+        colony = _mm256_or_si256(_mm256_blendv_epi8(colony, next, moving), trapped);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.colony_ids + i), colony);
+
+        // 16-bit move counts: subtracting the all-ones lane mask adds one
+        __m128i moving16 = _mm_packs_epi32(_mm256_castsi256_si128(moving), _mm256_extracti128_si256(moving, 1));
+        __m128i trapped16 = _mm_packs_epi32(_mm256_castsi256_si128(trapped), _mm256_extracti128_si256(trapped, 1));
+        __m128i at_or_above_max = _mm_cmpeq_epi16(_mm_max_epu16(counts16, max_moves), counts16);
+        counts16 = _mm_sub_epi16(counts16, moving16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.move_counts + i), counts16);
+
+        __m128i reached = _mm_and_si128(_mm_cmpeq_epi16(counts16, max_moves), moving16);
+        tally.moved += _mm_popcnt_u32(_mm256_movemask_ps(_mm256_castsi256_ps(moving)));
+        tally.trapped += _mm_popcnt_u32(_mm256_movemask_ps(_mm256_castsi256_ps(trapped)));
+        tally.reached_max += _mm_popcnt_u32(_mm_movemask_epi8(reached)) / 2;
+        tally.trapped_at_max += _mm_popcnt_u32(_mm_movemask_epi8(_mm_and_si128(trapped16, at_or_above_max))) / 2;
+    }
+    return i;
+}
+
+// One non-template entry point per instantiation: GCC drops the target attribute from
+// explicitly instantiated templates, which breaks builds without -mavx2 (e.g. Debug)
+AVX2_TARGET uint32_t moveXoshiroNarrow(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally) {
+    return moveKernel<RngKind::XOSHIRO, uint16_t>(batch, begin, end, tally);
+}
+AVX2_TARGET uint32_t moveXoshiroWide(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally) {
+    return moveKernel<RngKind::XOSHIRO, uint32_t>(batch, begin, end, tally);
+}
+AVX2_TARGET uint32_t moveCounterNarrow(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally) {
+    return moveKernel<RngKind::COUNTER, uint16_t>(batch, begin, end, tally);
+}
+AVX2_TARGET uint32_t moveCounterWide(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally) {
+    return moveKernel<RngKind::COUNTER, uint32_t>(batch, begin, end, tally);
+}
+
+}  // namespace
+
+template <RngKind KIND, typename ColonyId>
+uint32_t moveAntsVectorized(const MoveBatch& batch, uint32_t begin, uint32_t end, MoveTally& tally) {
+    constexpr bool narrow = sizeof(ColonyId) == sizeof(uint16_t);
+    if constexpr (KIND == RngKind::XOSHIRO) {
+        return narrow ? moveXoshiroNarrow(batch, begin, end, tally) : moveXoshiroWide(batch, begin, end, tally);
+    } else {
+        return narrow ? moveCounterNarrow(batch, begin, end, tally) : moveCounterWide(batch, begin, end, tally);
+    }
+}
+
+#else
+
+template <RngKind KIND, typename ColonyId>
+uint32_t moveAntsVectorized(const MoveBatch&, uint32_t begin, uint32_t, MoveTally&) {
+    return begin;  // No vector kernel on this platform; everything takes the scalar path
+}
+
+#endif
+
+template uint32_t moveAntsVectorized<RngKind::XOSHIRO, uint16_t>(const MoveBatch&, uint32_t, uint32_t, MoveTally&);
+template uint32_t moveAntsVectorized<RngKind::XOSHIRO, uint32_t>(const MoveBatch&, uint32_t, uint32_t, MoveTally&);
+template uint32_t moveAntsVectorized<RngKind::COUNTER, uint16_t>(const MoveBatch&, uint32_t, uint32_t, MoveTally&);
+template uint32_t moveAntsVectorized<RngKind::COUNTER, uint32_t>(const MoveBatch&, uint32_t, uint32_t, MoveTally&);
@@ -0,0 +1,76 @@
+#include "name_index.h"
+
+#include <cstring>
+
+NameIndex::NameIndex(const std::string& name_blob, const std::vector<uint32_t>& name_offsets)
+    : count(0)
+    , names(name_blob)
+    , offsets(name_offsets) {}
+
+uint32_t NameIndex::hash(std::string_view name) {
+    // Multiply-xorshift over 8-byte words; names are short, so this is a few multiplies
+    const char* p = name.data();
+    const size_t n = name.size();
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    if (i < n) {
+        uint64_t word = 0;
+        std::memcpy(&word, p + i, n - i);
+        h = (h ^ word) * 0x94D049BB133111EBULL;
+        h ^= h >> 29;
+    }
+    h *= 0xFF51AFD7ED558CCDULL;
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+void NameIndex::reserve(size_t expected) {
+    size_t capacity = 16;
+    while (capacity < expected * 2) capacity *= 2;
+    if (capacity > slots.size()) rehash(capacity);
+}
+
+void NameIndex::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{0, EMPTY});
+    old.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == EMPTY) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].id != EMPTY) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+bool NameIndex::insert(std::string_view name, uint32_t hash, uint32_t id) {
+    if ((count + 1) * 2 > slots.size()) rehash(slots.empty() ? 16 : slots.size() * 2);
+
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].id != EMPTY) {
+        if (slots[i].hash == hash && nameOf(slots[i].id) == name) {
+            slots[i].id = id;
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+    slots[i] = {hash, id};
+    count++;
+    return true;
+}
+
+uint32_t NameIndex::find(std::string_view name, uint32_t hash) const {
+    if (slots.empty()) return NOT_FOUND;
+
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; slots[i].id != EMPTY; i = (i + 1) & mask) {
+        // Names are only compared on a full hash match
+        if (slots[i].hash == hash && nameOf(slots[i].id) == name) return slots[i].id;
+    }
+    return NOT_FOUND;
+}
@@ -0,0 +1,145 @@
+#include "output_sink.h"
+
+#include <cstring>
+
+// Two-digit lookup for integer formatting
+static constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+OutputSink::OutputSink(std::ostream& os, size_t buffer_capacity)
+    : stream(&os)
+    , buffer(new char[buffer_capacity])
+    , capacity(buffer_capacity)
+    , used(0)
+    , quiet(false)
+    , message_count(0)
+    , async(false)
+    , pending(new char[buffer_capacity])
+    , pending_size(0)
+    , pending_ready(false)
+    , stopping(false) {}
+
+OutputSink::~OutputSink() {
+    setAsync(false);
+    flush();
+}
+
+void OutputSink::setStream(std::ostream& os) {
+    flush();
+    stream = &os;
+}
+
+void OutputSink::setAsync(bool enabled) {
+    if (enabled == async) return;
+    
+    if (enabled) {
+        stopping = false;
+        async = true;
+        writer = std::thread(&OutputSink::writerLoop, this);
+    } else {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        writer.join();
+        async = false;
+    }
+}
+
+void OutputSink::handOff() {
+    if (used == 0) return;
+    
+    if (!async) {
+        stream->write(buffer.get(), static_cast<std::streamsize>(used));
+        used = 0;
+        return;
+    }
+    
+    // Wait for the writer to finish the previous chunk, then swap buffers
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !pending_ready; });
+    std::swap(buffer, pending);
+    pending_size = used;
+    pending_ready = true;
+    used = 0;
+    lock.unlock();
+    cv.notify_all();
+}
+
+void OutputSink::waitForWriter() {
+    if (!async) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !pending_ready; });
+}
+
+void OutputSink::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return pending_ready || stopping; });
+        if (pending_ready) {
+            lock.unlock();
+            stream->write(pending.get(), static_cast<std::streamsize>(pending_size));
+            lock.lock();
+            pending_ready = false;
+            cv.notify_all();
+        } else {
+            return;
+        }
+    }
+}
+
+OutputSink& OutputSink::write(std::string_view text) {
+    if (text.size() > capacity) {
+        // Oversized text bypasses the buffer, after everything queued before it
+        flush();
+        stream->write(text.data(), static_cast<std::streamsize>(text.size()));
+        return *this;
+    }
+    std::memcpy(reserve(text.size()), text.data(), text.size());
+    used += text.size();
+    return *this;
+}
+
+OutputSink& OutputSink::writeUint(uint64_t value) {
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    
+    while (value >= 100) {
+        const char* pair = DIGIT_PAIRS + (value % 100) * 2;
+        value /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (value >= 10) {
+        const char* pair = DIGIT_PAIRS + value * 2;
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    
+    return write(std::string_view(p, static_cast<size_t>(end - p)));
+}
+
+void OutputSink::destructionMessage(std::string_view colony, uint32_t ant_a, uint32_t ant_b) {
+    message_count++;
+    if (quiet) return;
+    
+    write(colony);
+    write(" has been destroyed by ant ");
+    writeUint(ant_a);
+    write(" and ant ");
+    writeUint(ant_b);
+    write("!\n");
+}
+
+void OutputSink::flush() {
+    handOff();
+    waitForWriter();
+    stream->flush();
+}
@@ -0,0 +1,19 @@
+#include "simulation_observer.h"
+
+#include <iostream>
+
+void ConsoleObserver::runEnd(const RunEndEvent& event) {
+    // Buffered messages must land before the summary
+    output.flush();
+
+    if (silent) return;
+
+    if (output.isQuiet()) {
+        std::cout << "Destruction messages suppressed: " << output.getMessageCount() << std::endl;
+    }
+    std::cout << "\nSimulation completed in " << event.microseconds << " microseconds" << std::endl;
+    std::cout << "Total iterations: " << event.iterations << std::endl;
+    std::cout << "Total fight pairs: " << event.fight_pairs << std::endl;
+    std::cout << "Colonies destroyed: " << event.colonies_destroyed << std::endl;
+    std::cout << "Ants remaining: " << event.ants_remaining << std::endl;
+}
@@ -0,0 +1,67 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(uint32_t num_threads)
+    : task(nullptr)
+    , generation(0)
+    , active_workers(0)
+    , pending(0)
+    , stopping(false) {
+    // The caller is worker 0, so only num_threads - 1 helpers are spawned
+    for (uint32_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(uint32_t active, const std::function<void(uint32_t)>& fn) {
+    if (active > size()) active = size();
+    if (active <= 1) {
+        fn(0);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        active_workers = active;
+        pending = active - 1;
+        generation++;
+    }
+    start_cv.notify_all();
+    
+    fn(0);
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::workerLoop(uint32_t index) {
+    uint64_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    while (true) {
+        start_cv.wait(lock, [&] { return stopping || generation != seen_generation; });
+        if (stopping) return;
+        seen_generation = generation;
+        if (index >= active_workers) continue;
+        
+        const std::function<void(uint32_t)>* fn = task;
+        lock.unlock();
+        (*fn)(index);
+        lock.lock();
+        
+        if (--pending == 0) {
+            done_cv.notify_one();
+        }
+    }
+}
@@ -1,7 +1,16 @@
 #include <gtest/gtest.h>
 #include <fstream>
 #include <sstream>
+#include <cstring>
+#include <functional>
+#include <algorithm>
+#include <map>
+#include <numeric>
 #include "ant_mania.h"
+#include "binary_map.h"
+#include "map_generator.h"
+#include "name_index.h"
+#include "ensemble.h"
 
 class AntManiaTest : public ::testing::Test {
 protected:
@@ -20,6 +29,16 @@ protected:
         // Clean up test files
         std::remove("test_map.txt");
         std::remove("empty_map.txt");
+        std::remove("forward_map.txt");
+        std::remove("pair_map.txt");
+        std::remove("grid_map.txt");
+        std::remove("island_map.txt");
+        std::remove("grid_map.antmap");
+        std::remove("shuffled_map.txt");
+        std::remove("large_map.txt");
+        std::remove("repeated_map.txt");
+        std::remove("huge_page_map.txt");
+        std::remove("hub_map.txt");
     }
     
     void captureOutput() {
@@ -31,6 +50,56 @@ protected:
         std::cout.rdbuf(old_cout);
     }
     
+    std::string capturedOutput() const {
+        return oss.str();
+    }
+    
+    // side x side grid (side <= 676) with bidirectional tunnels, alphabetic names
+    static void writeGridMap(const std::string& filename, int side = 10) {
+        auto letters = [](int v) { return std::string{char('a' + v / 26), char('a' + v % 26)}; };
+        auto name = [&](int x, int y) { return "Grid" + letters(x) + letters(y); };
+        std::ofstream file(filename);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                file << name(x, y);
+                if (y > 0) file << " north=" << name(x, y - 1);
+                if (y < side - 1) file << " south=" << name(x, y + 1);
+                if (x < side - 1) file << " east=" << name(x + 1, y);
+                if (x > 0) file << " west=" << name(x - 1, y);
+                file << "\n";
+            }
+        }
+    }
+    
+    // Full run output with the timing line removed, for comparing runs
+    std::string runSeeded(SimulationEngine engine, RngKind rng, uint64_t seed,
+                          uint32_t num_ants = 30, uint32_t threads = 1,
+                          const std::string& map_file = "grid_map.txt",
+                          ColonyOrder order = ColonyOrder::FILE, bool vector_moves = true) {
+        AntManiaSimulation sim;
+        sim.setEngine(engine);
+        sim.setColonyOrder(order);
+        sim.setVectorMoves(vector_moves);
+        sim.setRng(rng);
+        sim.setSeed(seed);
+        sim.setThreads(threads);
+        
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.loadMap(map_file);
+        sim.createAnts(num_ants);
+        sim.runSimulation();
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        
+        std::string text = out.str();
+        size_t timing = text.find("Simulation completed in");
+        if (timing != std::string::npos) {
+            text.erase(timing, text.find('\n', timing) - timing);
+        }
+        return text;
+    }
+    
 private:
     std::ostringstream oss;
     std::streambuf* old_cout;
@@ -87,4 +156,1186 @@ TEST_F(AntManiaTest, PerformanceWithLargerScale) {
     captureOutput();
     EXPECT_NO_THROW(sim.runSimulation());
     restoreOutput();
-}
\ No newline at end of file
+}
+// Test 6: Single-pass loader resolves forward references and tolerates CRLF/blank lines
+TEST_F(AntManiaTest, ForwardReferencesAndLineEndings) {
+    std::ofstream file("forward_map.txt");
+    file << "Alpha east=Beta south=Nowhere\r\n";
+    file << "\n";
+    file << "Beta west=Alpha north=Gamma\r\n";
+    file << "Gamma south=Beta";  // No trailing newline
+    file.close();
+    
+    AntManiaSimulation sim;
+    captureOutput();
+    EXPECT_TRUE(sim.loadMap("forward_map.txt"));
+    sim.printRemainingWorld();
+    restoreOutput();
+    
+    std::string output = capturedOutput();
+    EXPECT_NE(output.find("Loaded 3 colonies"), std::string::npos);
+    EXPECT_NE(output.find("Alpha east=Beta\n"), std::string::npos);
+    EXPECT_NE(output.find("Beta north=Gamma west=Alpha\n"), std::string::npos);
+    EXPECT_NE(output.find("Gamma south=Beta\n"), std::string::npos);
+}
+
+// Test 7: Collisions destroy occupied colonies and kill every occupant
+TEST_F(AntManiaTest, CollisionsKillAllOccupants) {
+    // With 100 ants on two linked colonies both are overrun on the first move
+    std::ofstream file("pair_map.txt");
+    file << "Left east=Right\n";
+    file << "Right west=Left\n";
+    file.close();
+    
+    AntManiaSimulation sim;
+    captureOutput();
+    sim.loadMap("pair_map.txt");
+    sim.createAnts(100);
+    sim.runSimulation();
+    sim.printStatistics();
+    restoreOutput();
+    
+    std::string output = capturedOutput();
+    EXPECT_NE(output.find("Left has been destroyed by ant "), std::string::npos);
+    EXPECT_NE(output.find("Right has been destroyed by ant "), std::string::npos);
+    EXPECT_NE(output.find("Colonies destroyed: 2\n"), std::string::npos);
+    EXPECT_NE(output.find("Ants remaining: 0\n"), std::string::npos);
+}
+
+// Test 8: Fused engine gives the same outcome on a deterministic collision map
+TEST_F(AntManiaTest, FusedEngineCollisions) {
+    std::ofstream file("pair_map.txt");
+    file << "Left east=Right\n";
+    file << "Right west=Left\n";
+    file.close();
+    
+    AntManiaSimulation sim;
+    sim.setEngine(SimulationEngine::FUSED);
+    captureOutput();
+    sim.loadMap("pair_map.txt");
+    sim.createAnts(100);
+    sim.runSimulation();
+    sim.printStatistics();
+    restoreOutput();
+    
+    std::string output = capturedOutput();
+    EXPECT_NE(output.find("Colonies destroyed: 2\n"), std::string::npos);
+    EXPECT_NE(output.find("Ants remaining: 0\n"), std::string::npos);
+}
+
+// Test 9: Compaction drops dead ants and keeps survivors in order with their IDs
+TEST_F(AntManiaTest, AntStoreCompaction) {
+    AntStore store;
+    for (uint32_t i = 0; i < 6; ++i) {
+        store.add(i * 10, i);
+    }
+    store.kill(0);
+    store.kill(3);
+    store.kill(4);
+    EXPECT_EQ(store.dead_count, 3u);
+    
+    store.compact();
+    ASSERT_EQ(store.size(), 3u);
+    EXPECT_EQ(store.dead_count, 0u);
+    EXPECT_EQ(store.ant_ids, (ArenaVector<uint32_t>{1, 2, 5}));
+    EXPECT_EQ(store.colony_ids, (ArenaVector<uint32_t>{10, 20, 50}));
+}
+
+// Test 10: A seed reproduces a run exactly, and both engines agree for a given seed
+TEST_F(AntManiaTest, SeededRunsAreReproducible) {
+    writeGridMap("grid_map.txt");
+    
+    for (RngKind rng : {RngKind::XOSHIRO, RngKind::MT19937}) {
+        std::string reference = runSeeded(SimulationEngine::TWO_PASS, rng, 1234);
+        EXPECT_NE(reference.find("has been destroyed"), std::string::npos);
+        EXPECT_EQ(reference, runSeeded(SimulationEngine::TWO_PASS, rng, 1234));
+        EXPECT_EQ(reference, runSeeded(SimulationEngine::FUSED, rng, 1234));
+    }
+}
+
+// Test 11: Parallel engine output is identical at any thread count and matches counter-RNG sequential runs
+TEST_F(AntManiaTest, ParallelEngineIsDeterministic) {
+    // Enough ants that the parallel engine actually fans out
+    writeGridMap("grid_map.txt", 200);
+    
+    std::string reference = runSeeded(SimulationEngine::TWO_PASS, RngKind::COUNTER, 99, 40000);
+    EXPECT_NE(reference.find("has been destroyed"), std::string::npos);
+    for (uint32_t threads : {1u, 2u, 4u}) {
+        EXPECT_EQ(reference, runSeeded(SimulationEngine::PARALLEL, RngKind::COUNTER, 99, 40000, threads));
+    }
+}
+
+// Test 12: Fast-forwarding isolated ants changes only the iteration count
+TEST_F(AntManiaTest, FastForwardIsolatedAnts) {
+    // Many small triangular islands (two ants on one always meet eventually);
+    // the "Dead" ones also have a one-way tunnel into a dead end
+    std::ofstream file("island_map.txt");
+    for (int i = 0; i < 20; ++i) {
+        std::string id{char('a' + i / 26), char('a' + i % 26)};
+        for (const char* kind : {"Isle", "Dead"}) {
+            std::string a = kind + id + "a", b = kind + id + "b", c = kind + id + "c";
+            file << a << " east=" << b << " south=" << c << "\n";
+            file << b << " west=" << a << " south=" << c;
+            if (kind[0] == 'D') file << " east=" << kind << id << "d";
+            file << "\n";
+            file << c << " north=" << a << " east=" << b << "\n";
+            if (kind[0] == 'D') file << kind << id << "d\n";
+        }
+    }
+    file.close();
+    
+    auto run = [](bool fast_forward, uint32_t& iterations) {
+        AntManiaSimulation sim;
+        sim.setRng(RngKind::COUNTER);  // Solo walks then replay the exact same draws
+        sim.setSeed(5);
+        sim.setFastForward(fast_forward);
+        
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.loadMap("island_map.txt");
+        sim.createAnts(60);
+        sim.runSimulation();
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        
+        std::string text = out.str();
+        for (const char* line : {"Simulation completed in", "Total iterations: ", "Iteration 10000:"}) {
+            size_t pos = text.find(line);
+            if (pos == std::string::npos) continue;
+            if (line[0] == 'T') iterations = std::stoul(text.substr(pos + std::strlen(line)));
+            text.erase(pos, text.find('\n', pos) - pos + 1);
+        }
+        return text;
+    };
+    
+    uint32_t iterations_ff = 0, iterations_full = 0;
+    std::string fast = run(true, iterations_ff);
+    std::string full = run(false, iterations_full);
+    EXPECT_EQ(fast, full);
+    EXPECT_EQ(iterations_full, 10001u);
+    EXPECT_LT(iterations_ff, iterations_full);
+}
+
+// Test 13: Output sink formats messages, counts them when quiet, and preserves order when async
+TEST_F(AntManiaTest, OutputSinkFormattingAndModes) {
+    std::ostringstream out;
+    {
+        OutputSink sink(out, 64);  // Tiny buffer forces many hand-offs
+        sink.setAsync(true);
+        for (uint32_t i = 0; i < 100; ++i) {
+            sink.destructionMessage("Fizz", i, 4294967295u);
+        }
+        sink.writeUint(0).write('\n');
+        sink.setQuiet(true);
+        sink.destructionMessage("Buzz", 1, 2);
+        EXPECT_EQ(sink.getMessageCount(), 101u);
+    }
+    
+    std::string text = out.str();
+    EXPECT_EQ(text.find("Buzz"), std::string::npos);
+    EXPECT_EQ(text.rfind("Fizz has been destroyed by ant 0 and ant 4294967295!\n", 0), 0u);
+    EXPECT_NE(text.find("Fizz has been destroyed by ant 99 and ant 4294967295!\n0\n"), std::string::npos);
+}
+
+// Test 14: Instrumentation ring buffer keeps the newest samples and totals everything
+TEST_F(AntManiaTest, InstrumentationRingBuffer) {
+    Instrumentation instrumentation(4);
+    instrumentation.start();
+    for (uint32_t i = 1; i <= 10; ++i) {
+        instrumentation.beginIteration(i, 100 - i, i * 10, i);
+        instrumentation.enterPhase(Phase::MOVE);
+        instrumentation.enterPhase(Phase::COLLIDE);
+        instrumentation.addTouched(3);
+        instrumentation.endIteration(i * 10 + 7, i + 1);
+    }
+    instrumentation.stop();
+    
+    EXPECT_EQ(instrumentation.iterationsRecorded(), 10u);
+    ASSERT_EQ(instrumentation.size(), 4u);
+    EXPECT_EQ(instrumentation.sample(0).iteration, 7u);
+    EXPECT_EQ(instrumentation.sample(3).iteration, 10u);
+    EXPECT_EQ(instrumentation.sample(3).live_ants, 90u);
+    EXPECT_EQ(instrumentation.sample(3).moved, 7u);
+    EXPECT_EQ(instrumentation.sample(3).touched, 3u);
+    EXPECT_EQ(instrumentation.sample(3).destroyed, 1u);
+    
+    std::ostringstream csv;
+    instrumentation.writeCsv(csv);
+    std::string text = csv.str();
+    EXPECT_EQ(text.rfind("iteration,live_ants,moved,touched,destroyed,move_ns", 0), 0u);
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), 5);
+    EXPECT_NE(text.find("\n7,93,7,3,1,"), std::string::npos);
+    
+#ifdef ANT_MANIA_INSTRUMENT
+    // Instrumented builds record one sample per simulated iteration
+    AntManiaSimulation sim;
+    sim.setSeed(7);
+    ASSERT_TRUE(sim.loadMap("test_map.txt"));
+    captureOutput();
+    sim.createAnts(5);
+    sim.runSimulation();
+    restoreOutput();
+    EXPECT_EQ(sim.getInstrumentation().iterationsRecorded() + 1, sim.getIterations());
+#endif
+}
+
+// Test 15: A compiled binary map loads to the same world and seeded run as its text source
+TEST_F(AntManiaTest, BinaryMapRoundTrip) {
+    writeGridMap("grid_map.txt");
+    {
+        AntManiaSimulation sim;
+        captureOutput();
+        ASSERT_TRUE(sim.loadMap("grid_map.txt"));
+        restoreOutput();
+        ASSERT_TRUE(sim.compileMap("grid_map.antmap"));
+    }
+    
+    auto without_load_line = [](std::string text) {
+        return text.substr(text.find('\n') + 1);
+    };
+    std::string text_run = runSeeded(SimulationEngine::TWO_PASS, RngKind::XOSHIRO, 99);
+    std::string binary_run = runSeeded(SimulationEngine::TWO_PASS, RngKind::XOSHIRO, 99, 30, 1, "grid_map.antmap");
+    EXPECT_NE(text_run.find("has been destroyed"), std::string::npos);
+    EXPECT_EQ(without_load_line(text_run), without_load_line(binary_run));
+    
+    // Truncated files are rejected instead of read out of bounds
+    std::string bytes;
+    {
+        std::ifstream in("grid_map.antmap", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out("grid_map.antmap", std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+    }
+    AntManiaSimulation sim;
+    EXPECT_FALSE(sim.loadMap("grid_map.antmap"));
+    
+    // So is a reverse index that disagrees with the connections, even with every entry in range
+    BinaryMapHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    auto align8 = [](size_t offset) { return (offset + 7) & ~size_t{7}; };
+    const size_t offsets_at = align8(align8(sizeof(header)) + size_t{header.colony_count} * 4 * sizeof(uint32_t));
+    const size_t edges_at = align8(offsets_at + (size_t{header.colony_count} + 1) * sizeof(uint32_t));
+    auto edge = [&](std::string& file, uint32_t e) { return reinterpret_cast<uint32_t*>(&file[edges_at]) + e; };
+    
+    std::vector<std::function<void(std::string&)>> corruptions = {
+        [&](std::string& file) { std::swap(*edge(file, 0), *edge(file, 1)); },          // Out of order
+        [&](std::string& file) { *edge(file, 1) = *edge(file, 0); },                    // Repeated
+        [&](std::string& file) { *edge(file, 0) = (header.colony_count - 1) << 2 | 3; }  // Not a tunnel into colony 0
+    };
+    for (auto& corrupt : corruptions) {
+        std::string corrupted = bytes;
+        corrupt(corrupted);
+        {
+            std::ofstream out("grid_map.antmap", std::ios::binary | std::ios::trunc);
+            out.write(corrupted.data(), static_cast<std::streamsize>(corrupted.size()));
+        }
+        std::ostringstream errors;
+        std::streambuf* previous = std::cerr.rdbuf(errors.rdbuf());
+        EXPECT_FALSE(sim.loadMap("grid_map.antmap"));
+        std::cerr.rdbuf(previous);
+        EXPECT_NE(errors.str().find("reverse index does not match"), std::string::npos) << errors.str();
+    }
+}
+
+// Test 16: Generated maps are spec-conformant: unique alphabetic names, reciprocal tunnels
+TEST_F(AntManiaTest, GeneratedMapsAreConsistent) {
+    for (MapTopology topology : {MapTopology::GRID, MapTopology::RANDOM}) {
+        MapGeneratorConfig config;
+        config.colonies = 500;
+        config.topology = topology;
+        config.missing_edge_ratio = 0.25;
+        config.shuffle_lines = (topology == MapTopology::GRID);
+        std::ostringstream out;
+        ASSERT_TRUE(generateMap(config, out));
+        
+        // name -> target per direction
+        std::map<std::string, std::map<std::string, std::string>> tunnels;
+        std::istringstream lines(out.str());
+        std::string line;
+        size_t edges = 0;
+        while (std::getline(lines, line)) {
+            std::istringstream tokens(line);
+            std::string name, token;
+            tokens >> name;
+            EXPECT_TRUE(std::all_of(name.begin(), name.end(), ::isalpha)) << name;
+            EXPECT_EQ(tunnels.count(name), 0u) << "duplicate " << name;
+            auto& entry = tunnels[name];
+            while (tokens >> token) {
+                size_t eq = token.find('=');
+                entry[token.substr(0, eq)] = token.substr(eq + 1);
+                edges++;
+            }
+        }
+        EXPECT_EQ(tunnels.size(), 500u);
+        
+        const std::map<std::string, std::string> opposite = {
+            {"north", "south"}, {"south", "north"}, {"east", "west"}, {"west", "east"}};
+        for (const auto& [name, entry] : tunnels) {
+            for (const auto& [dir, target] : entry) {
+                ASSERT_EQ(tunnels.count(target), 1u) << name << " " << dir << "=" << target;
+                EXPECT_EQ(tunnels[target][opposite.at(dir)], name) << name << " " << dir << "=" << target;
+            }
+        }
+        
+        // About a quarter of the ~2 tunnels per colony are dropped (each written twice)
+        EXPECT_GT(edges, 500u * 2 * 2 * 0.6);
+        EXPECT_LT(edges, 500u * 2 * 2 * 0.9);
+    }
+}
+
+// Test 17: Ensemble trials share one graph, match standalone runs and ignore thread count
+TEST_F(AntManiaTest, EnsembleMatchesStandaloneRuns) {
+    writeGridMap("grid_map.txt");
+    auto graph = std::make_shared<ColonyGraph>();
+    ASSERT_TRUE(graph->load("grid_map.txt"));
+    
+    EnsembleConfig config;
+    config.trials = 12;
+    config.ants = 30;
+    config.base_seed = 500;
+    EnsembleResult single = runEnsemble(graph, config);
+    config.threads = 3;
+    EnsembleResult threaded = runEnsemble(graph, config);
+    
+    uint32_t destroyed_total = 0;
+    for (uint32_t t = 0; t < config.trials; ++t) {
+        // A fresh simulation with the trial's seed reproduces it exactly
+        AntManiaSimulation sim;
+        sim.setSilent(true);
+        sim.setGraph(graph);
+        sim.setSeed(500 + t);
+        sim.createAnts(30);
+        sim.runSimulation();
+        
+        EXPECT_EQ(single.trials[t].colonies_destroyed, sim.getColoniesDestroyed());
+        EXPECT_EQ(single.trials[t].ants_remaining, sim.getAntsRemaining());
+        EXPECT_EQ(single.trials[t].iterations, sim.getIterations());
+        EXPECT_EQ(threaded.trials[t].colonies_destroyed, single.trials[t].colonies_destroyed);
+        EXPECT_EQ(threaded.trials[t].fight_pairs, single.trials[t].fight_pairs);
+        destroyed_total += single.trials[t].colonies_destroyed;
+    }
+    EXPECT_GT(destroyed_total, 0u);
+    EXPECT_EQ(std::accumulate(single.destroyed_counts.begin(), single.destroyed_counts.end(), 0u), destroyed_total);
+    EXPECT_EQ(single.destroyed_counts, threaded.destroyed_counts);
+}
+
+// Test 18: Renumbering colonies for locality changes nothing that is reported
+TEST_F(AntManiaTest, ReorderedColoniesGiveIdenticalOutput) {
+    MapGeneratorConfig config;
+    config.colonies = 2500;
+    config.missing_edge_ratio = 0.1;
+    config.shuffle_lines = true;
+    ASSERT_TRUE(generateMap(config, "shuffled_map.txt"));
+    
+    ColonyGraph file_order;
+    ASSERT_TRUE(file_order.load("shuffled_map.txt"));
+    
+    // Sum of |a - b| over all tunnels: how far apart neighbours are in memory
+    auto tunnel_spread = [](const ColonyGraph& graph) {
+        uint64_t spread = 0;
+        for (uint32_t self = 0; self < graph.size(); ++self) {
+            for (uint32_t target : graph.connections(self)) {
+                if (target != ColonyGraph::NO_CONNECTION) spread += target > self ? target - self : self - target;
+            }
+        }
+        return spread;
+    };
+    
+    for (ColonyOrder order : {ColonyOrder::BFS, ColonyOrder::RCM}) {
+        ColonyGraph reordered;
+        ASSERT_TRUE(reordered.load("shuffled_map.txt"));
+        reordered.reorder(order);
+        ASSERT_TRUE(reordered.isReordered());
+        EXPECT_FALSE(reordered.compile("grid_map.antmap"));
+        EXPECT_LT(tunnel_spread(reordered) * 10, tunnel_spread(file_order));
+        
+        // Same colonies, names and tunnels, only renumbered
+        ASSERT_EQ(reordered.size(), file_order.size());
+        for (uint32_t k = 0; k < file_order.size(); ++k) {
+            uint32_t id = reordered.colonyAtFileIndex(k);
+            ASSERT_EQ(reordered.fileIndex(id), k);
+            EXPECT_EQ(reordered.name(id), file_order.name(k));
+            for (int dir = 0; dir < 4; ++dir) {
+                uint32_t expected = file_order.connection(k, dir);
+                uint32_t actual = reordered.connection(id, dir);
+                EXPECT_EQ(actual == ColonyGraph::NO_CONNECTION ? actual : reordered.fileIndex(actual), expected);
+            }
+        }
+    }
+    
+    for (RngKind rng : {RngKind::XOSHIRO, RngKind::COUNTER}) {
+        for (SimulationEngine engine : {SimulationEngine::TWO_PASS, SimulationEngine::FUSED}) {
+            std::string reference = runSeeded(engine, rng, 77, 600, 1, "shuffled_map.txt");
+            EXPECT_NE(reference.find("has been destroyed"), std::string::npos);
+            EXPECT_EQ(reference, runSeeded(engine, rng, 77, 600, 1, "shuffled_map.txt", ColonyOrder::BFS));
+            EXPECT_EQ(reference, runSeeded(engine, rng, 77, 600, 1, "shuffled_map.txt", ColonyOrder::RCM));
+        }
+    }
+}
+
+// Test 19: Connection IDs are 16-bit below 65535 colonies and 32-bit above
+TEST_F(AntManiaTest, ConnectionWidthFollowsMapSize) {
+    const uint8_t NORTH = static_cast<uint8_t>(Direction::NORTH);
+    const uint8_t SOUTH = static_cast<uint8_t>(Direction::SOUTH);
+    
+    writeGridMap("grid_map.txt");
+    ColonyGraph small;
+    ASSERT_TRUE(small.load("grid_map.txt"));
+    EXPECT_TRUE(small.hasNarrowIds());
+    EXPECT_EQ(small.connectionTableBytes(), 100u * 4 * sizeof(uint16_t));
+    EXPECT_EQ(small.connection(0, SOUTH), 10u);
+    EXPECT_EQ(small.connection(0, NORTH), ColonyGraph::NO_CONNECTION);
+    
+    // The binary format is always 32-bit; loading narrows it again
+    ASSERT_TRUE(small.compile("grid_map.antmap"));
+    ColonyGraph compiled;
+    ASSERT_TRUE(compiled.load("grid_map.antmap"));
+    EXPECT_TRUE(compiled.hasNarrowIds());
+    for (uint32_t c = 0; c < small.size(); ++c) {
+        EXPECT_EQ(compiled.connections(c), small.connections(c));
+    }
+    
+    MapGeneratorConfig config;
+    config.colonies = 70000;  // 265 wide
+    ASSERT_TRUE(generateMap(config, "large_map.txt"));
+    auto large = std::make_shared<ColonyGraph>();
+    ASSERT_TRUE(large->load("large_map.txt"));
+    EXPECT_FALSE(large->hasNarrowIds());
+    EXPECT_EQ(large->connectionTableBytes(), 70000u * 4 * sizeof(uint32_t));
+    EXPECT_EQ(large->connection(0, SOUTH), 265u);
+    EXPECT_EQ(large->connection(69999, SOUTH), ColonyGraph::NO_CONNECTION);
+    
+    // Destroyed state lives in a bitmap that spans several words
+    AntManiaSimulation sim;
+    sim.setSilent(true);
+    sim.setRng(RngKind::COUNTER);
+    sim.setSeed(3);
+    sim.setGraph(large);
+    sim.createAnts(20000);
+    sim.runSimulation();
+    uint32_t destroyed = 0;
+    for (uint32_t c = 0; c < large->size(); ++c) {
+        destroyed += sim.isColonyDestroyed(c);
+    }
+    EXPECT_GT(destroyed, 0u);
+    EXPECT_EQ(destroyed, sim.getColoniesDestroyed());
+}
+
+// Test 20: Flat name index finds every name, keeps the last ID of a repeated name, and grows
+TEST_F(AntManiaTest, NameIndexLookups) {
+    std::string names;
+    std::vector<uint32_t> offsets = {0};
+    NameIndex index(names, offsets);
+    EXPECT_EQ(index.find("Anything"), NameIndex::NOT_FOUND);
+    
+    // Starts small so the table has to grow several times
+    const uint32_t count = 5000;
+    for (uint32_t id = 0; id < count; ++id) {
+        std::string name = colonyNameFor(id);
+        names += name;
+        offsets.push_back(static_cast<uint32_t>(names.size()));
+        index.insert(name, NameIndex::hash(name), id);
+    }
+    EXPECT_EQ(index.size(), count);
+    EXPECT_GE(index.capacity(), 2u * count);
+    for (uint32_t id = 0; id < count; ++id) {
+        ASSERT_EQ(index.find(colonyNameFor(id)), id);
+    }
+    EXPECT_EQ(index.find("Col"), NameIndex::NOT_FOUND);
+    EXPECT_EQ(index.find(""), NameIndex::NOT_FOUND);
+    
+    names += "Colb";
+    offsets.push_back(static_cast<uint32_t>(names.size()));
+    index.insert("Colb", NameIndex::hash("Colb"), count);
+    EXPECT_EQ(index.size(), count);
+    EXPECT_EQ(index.find("Colb"), count);
+    
+    // Equal names hash equally wherever they live; long names cover the 8-byte loop
+    std::string long_name(37, 'q');
+    EXPECT_EQ(NameIndex::hash(long_name), NameIndex::hash(std::string_view(std::string(37, 'q'))));
+    EXPECT_NE(NameIndex::hash(long_name), NameIndex::hash(long_name.substr(1)));
+}
+
+// Test 21: Parallel parsing assigns exactly the IDs and tunnels of the sequential parser
+TEST_F(AntManiaTest, ParallelLoadMatchesSequential) {
+    MapGeneratorConfig config;
+    config.colonies = 30000;
+    config.missing_edge_ratio = 0.1;
+    config.shuffle_lines = true;
+    std::ostringstream generated;
+    ASSERT_TRUE(generateMap(config, generated));
+    
+    // Quirks the sequential parser resolves by position: a repeated direction where a
+    // later-defined target beats an earlier one, unknown targets, junk tokens, blank lines
+    const std::string quirks = "Alpha north=Beta north=Alpha west=Nowhere junk up=Colb\r\n"
+                               "\n   \n"
+                               "Beta south=Alpha east=Gamma east=Alpha\n"
+                               "Gamma west=Beta\n";
+    std::string text = quirks + generated.str() + "Omega north=Alpha south=Omega";
+    {
+        std::ofstream file("large_map.txt", std::ios::binary);
+        file << text;
+    }
+    {
+        std::ofstream file("repeated_map.txt", std::ios::binary);
+        file << text << "\nBeta north=Gamma\n";
+    }
+    
+    for (const char* map_file : {"large_map.txt", "repeated_map.txt"}) {
+        // A fix-up resolves to the last Beta in the file
+        const bool repeated = std::string(map_file) == "repeated_map.txt";
+        ColonyGraph sequential;
+        ASSERT_TRUE(sequential.load(map_file));
+        ASSERT_EQ(sequential.size(), repeated ? 30005u : 30004u);
+        EXPECT_EQ(sequential.connection(0, static_cast<uint8_t>(Direction::NORTH)), repeated ? 30004u : 1u);
+        EXPECT_EQ(sequential.connection(1, static_cast<uint8_t>(Direction::EAST)), 2u);
+        
+        for (uint32_t threads : {2u, 3u, 4u, 8u}) {
+            ColonyGraph parallel;
+            ASSERT_TRUE(parallel.load(map_file, threads));
+            ASSERT_EQ(parallel.size(), sequential.size());
+            for (uint32_t c = 0; c < sequential.size(); ++c) {
+                ASSERT_EQ(parallel.name(c), sequential.name(c)) << map_file << " threads " << threads;
+                ASSERT_EQ(parallel.connections(c), sequential.connections(c)) << map_file << " colony " << c;
+            }
+        }
+    }
+}
+
+// Test 22: The AVX2 move kernel reproduces the scalar move loop exactly, narrow and wide IDs
+TEST_F(AntManiaTest, VectorMovesMatchScalar) {
+    if (!moveKernelAvailable()) GTEST_SKIP() << "CPU has no AVX2";
+    
+    MapGeneratorConfig config;
+    config.colonies = 2500;
+    config.missing_edge_ratio = 0.3;  // Plenty of dead ends, so ants get trapped too
+    ASSERT_TRUE(generateMap(config, "shuffled_map.txt"));
+    config.colonies = 70000;
+    ASSERT_TRUE(generateMap(config, "large_map.txt"));
+    
+    // Ant counts that leave a scalar tail after the last batch of eight
+    for (RngKind rng : {RngKind::XOSHIRO, RngKind::COUNTER}) {
+        for (SimulationEngine engine : {SimulationEngine::TWO_PASS, SimulationEngine::FUSED}) {
+            std::string vector = runSeeded(engine, rng, 91, 1003, 1, "shuffled_map.txt");
+            EXPECT_NE(vector.find("has been destroyed"), std::string::npos);
+            EXPECT_EQ(vector, runSeeded(engine, rng, 91, 1003, 1, "shuffled_map.txt", ColonyOrder::FILE, false));
+        }
+        std::string vector = runSeeded(SimulationEngine::TWO_PASS, rng, 92, 5005, 1, "large_map.txt");
+        EXPECT_EQ(vector, runSeeded(SimulationEngine::TWO_PASS, rng, 92, 5005, 1, "large_map.txt", ColonyOrder::FILE, false));
+    }
+}
+
+// Test 23: A run restored from a mid-run checkpoint finishes exactly like the uninterrupted run
+TEST_F(AntManiaTest, CheckpointResumeIsBitExact) {
+    MapGeneratorConfig config;
+    config.colonies = 2500;
+    config.missing_edge_ratio = 0.05;
+    ASSERT_TRUE(generateMap(config, "shuffled_map.txt"));
+    
+    // Destruction lines plus everything the run reports about its final state
+    auto finish = [](AntManiaSimulation& sim) {
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.runSimulation();
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        
+        std::string lines;
+        std::istringstream in(out.str());
+        for (std::string line; std::getline(in, line);) {
+            if (line.find("Simulation completed") == std::string::npos && line.find("Starting") == std::string::npos) {
+                lines += line + "\n";
+            }
+        }
+        return lines;
+    };
+    auto totals = [](const AntManiaSimulation& sim) {
+        return std::vector<uint64_t>{sim.getIterations(), sim.getColoniesDestroyed(), sim.getFightPairs(),
+                                     sim.getAntsRemaining(), sim.getAntSteps(), sim.getMessageCount()};
+    };
+    
+    for (RngKind rng : {RngKind::XOSHIRO, RngKind::MT19937, RngKind::COUNTER}) {
+        for (SimulationEngine engine : {SimulationEngine::TWO_PASS, SimulationEngine::PARALLEL}) {
+            AntManiaSimulation reference;
+            reference.setSilent(true);
+            reference.setRng(rng);
+            reference.setEngine(engine);
+            reference.setThreads(2);
+            reference.setSeed(17);
+            ASSERT_TRUE(reference.loadMap("shuffled_map.txt"));
+            reference.createAnts(1500);
+            reference.runSimulation();
+            
+            // One checkpoint, just past halfway
+            const uint32_t interval = reference.getIterations() / 2 + 1;
+            ASSERT_GT(interval, 1u);
+            
+            AntManiaSimulation checkpointed;
+            checkpointed.setRng(rng);
+            checkpointed.setEngine(engine);
+            checkpointed.setThreads(2);
+            checkpointed.setSeed(17);
+            checkpointed.setSilent(true);
+            ASSERT_TRUE(checkpointed.loadMap("shuffled_map.txt"));
+            checkpointed.createAnts(1500);
+            checkpointed.setSilent(false);
+            checkpointed.setCheckpoint("checkpoint.bin", interval);
+            std::string full = finish(checkpointed);
+            EXPECT_EQ(totals(checkpointed), totals(reference));
+            
+            // Configuration comes from the checkpoint, not from the restoring simulation
+            AntManiaSimulation resumed;
+            resumed.setSilent(true);
+            resumed.setGraph(checkpointed.getGraph());
+            ASSERT_TRUE(resumed.restoreCheckpoint("checkpoint.bin"));
+            EXPECT_EQ(resumed.getIterations(), interval);
+            EXPECT_EQ(resumed.getRng(), rng);
+            EXPECT_EQ(resumed.getEngine(), engine);
+            EXPECT_GT(resumed.getAntsRemaining(), 0u);
+            EXPECT_LT(resumed.getAntSteps(), reference.getAntSteps());
+            resumed.setSilent(false);
+            std::string rest = finish(resumed);
+            
+            EXPECT_EQ(totals(resumed), totals(reference));
+            ASSERT_LE(rest.size(), full.size());
+            EXPECT_EQ(full.substr(full.size() - rest.size()), rest);
+        }
+    }
+    
+    // Truncated files and other maps are refused
+    std::string bytes;
+    {
+        std::ifstream in("checkpoint.bin", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out("checkpoint.bin", std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 4));
+    }
+    AntManiaSimulation sim;
+    sim.setSilent(true);
+    ASSERT_TRUE(sim.loadMap("shuffled_map.txt"));
+    std::ostringstream errors;
+    std::streambuf* previous = std::cerr.rdbuf(errors.rdbuf());
+    EXPECT_FALSE(sim.restoreCheckpoint("checkpoint.bin"));
+    {
+        std::ofstream out("checkpoint.bin", std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    EXPECT_TRUE(sim.restoreCheckpoint("checkpoint.bin"));
+    ASSERT_TRUE(sim.loadMap("test_map.txt"));
+    EXPECT_FALSE(sim.restoreCheckpoint("checkpoint.bin"));
+    std::cerr.rdbuf(previous);
+    EXPECT_NE(errors.str().find("truncated"), std::string::npos);
+    EXPECT_NE(errors.str().find("different map"), std::string::npos);
+    std::remove("checkpoint.bin");
+}
+
+// Observers whose antTrapped is overloaded or a template (local classes cannot have member templates)
+struct OverloadedTrapCounter : NullObserver {
+    uint64_t trapped = 0;
+    void antTrapped(const AntTrappedEvent&) { trapped++; }
+    void antTrapped(uint32_t ant_id) { (void)ant_id; }
+};
+struct TemplatedTrapCounter : NullObserver {
+    uint64_t trapped = 0;
+    template <typename Event>
+    void antTrapped(const Event&) { trapped++; }
+};
+
+// Test 24: Observer events match the console output and final totals in every engine
+TEST_F(AntManiaTest, ObserverEventsMatchConsoleOutput) {
+    MapGeneratorConfig config;
+    config.colonies = 2500;
+    config.missing_edge_ratio = 0.3;  // Dead ends, so ants get trapped too
+    ASSERT_TRUE(generateMap(config, "shuffled_map.txt"));
+    
+    struct Recorder : NullObserver {
+        std::string messages;
+        std::vector<std::array<uint32_t, 4>> trapped;  // Iteration, ant, colony, moves
+        uint64_t destroyed_ants = 0;
+        uint64_t fight_pairs = 0;
+        uint32_t destroyed = 0;
+        uint32_t last_iteration = 0;
+        bool ordered = true;
+        RunEndEvent end{};
+        
+        void colonyDestroyed(const ColonyDestroyedEvent& event) {
+            messages += std::string(event.colony) + " has been destroyed by ant " + std::to_string(event.ant_a) +
+                        " and ant " + std::to_string(event.ant_b) + "!\n";
+            destroyed_ants += event.ants;
+            fight_pairs += uint64_t{event.ants} * (event.ants - 1) / 2;
+            destroyed++;
+            ordered &= event.iteration == last_iteration + 1;
+        }
+        void antTrapped(const AntTrappedEvent& event) {
+            trapped.push_back({event.iteration, event.ant_id, event.colony_id, event.moves});
+            ordered &= event.iteration == last_iteration + 1;
+        }
+        void iterationEnd(const IterationEndEvent& event) {
+            ordered &= event.iteration == last_iteration + 1 && event.colonies_destroyed == destroyed;
+            last_iteration = event.iteration;
+        }
+        void runEnd(const RunEndEvent& event) { end = event; }
+    };
+    static_assert(observesTrappedAnts<Recorder>);
+    static_assert(!observesTrappedAnts<NullObserver> && !observesTrappedAnts<ConsoleObserver>);
+    static_assert(observesTrappedAnts<OverloadedTrapCounter> && observesTrappedAnts<TemplatedTrapCounter>);
+    
+    auto destructionLines = [](const std::string& text) {
+        std::string lines;
+        std::istringstream in(text);
+        for (std::string line; std::getline(in, line);) {
+            if (line.find("has been destroyed") != std::string::npos) lines += line + "\n";
+        }
+        return lines;
+    };
+    
+    struct Setup { SimulationEngine engine; bool vector_moves; uint32_t threads; };
+    const uint32_t num_ants = 40000;  // Enough for the parallel engine to fan out
+    std::vector<std::array<uint32_t, 4>> reference_trapped;
+    for (Setup setup : {Setup{SimulationEngine::TWO_PASS, true, 1}, Setup{SimulationEngine::TWO_PASS, false, 1},
+                        Setup{SimulationEngine::FUSED, true, 1}, Setup{SimulationEngine::PARALLEL, false, 2}}) {
+        AntManiaSimulation sim;
+        sim.setEngine(setup.engine);
+        sim.setVectorMoves(setup.vector_moves);
+        sim.setThreads(setup.threads);
+        sim.setRng(RngKind::COUNTER);
+        sim.setSeed(31);
+        sim.setSilent(true);
+        ASSERT_TRUE(sim.loadMap("shuffled_map.txt"));
+        sim.createAnts(num_ants);
+        Recorder recorder;
+        sim.run(recorder);
+        
+        EXPECT_TRUE(recorder.ordered);
+        EXPECT_EQ(recorder.messages,
+                  destructionLines(runSeeded(setup.engine, RngKind::COUNTER, 31, num_ants, setup.threads,
+                                             "shuffled_map.txt", ColonyOrder::FILE, setup.vector_moves)));
+        EXPECT_EQ(recorder.destroyed, sim.getColoniesDestroyed());
+        EXPECT_EQ(recorder.fight_pairs, sim.getFightPairs());
+        EXPECT_EQ(recorder.last_iteration + 1, sim.getIterations());
+        EXPECT_EQ(recorder.end.iterations, sim.getIterations());
+        EXPECT_EQ(recorder.end.ants_remaining, sim.getAntsRemaining());
+        EXPECT_EQ(recorder.end.ant_steps, sim.getAntSteps());
+        
+        // Every ant is accounted for: killed in a fight, trapped, or still alive
+        EXPECT_FALSE(recorder.trapped.empty());
+        EXPECT_EQ(recorder.destroyed_ants + recorder.trapped.size() + sim.getAntsRemaining(), num_ants);
+        if (reference_trapped.empty()) {
+            reference_trapped = recorder.trapped;
+        } else {
+            EXPECT_EQ(recorder.trapped, reference_trapped);
+        }
+        
+        // The no-op observer leaves the run itself unchanged
+        AntManiaSimulation quiet;
+        quiet.setEngine(setup.engine);
+        quiet.setVectorMoves(setup.vector_moves);
+        quiet.setThreads(setup.threads);
+        quiet.setRng(RngKind::COUNTER);
+        quiet.setSeed(31);
+        quiet.setSilent(true);
+        quiet.setGraph(sim.getGraph());
+        quiet.createAnts(num_ants);
+        NullObserver none;
+        quiet.run(none);
+        EXPECT_EQ(quiet.getIterations(), sim.getIterations());
+        EXPECT_EQ(quiet.getColoniesDestroyed(), sim.getColoniesDestroyed());
+        EXPECT_EQ(quiet.getAntSteps(), sim.getAntSteps());
+    }
+    
+    // Overloaded and templated hooks are detected and see every trapped ant
+    auto countTrapped = [&](auto observer) {
+        AntManiaSimulation sim;
+        sim.setRng(RngKind::COUNTER);
+        sim.setSeed(31);
+        sim.setSilent(true);
+        EXPECT_TRUE(sim.loadMap("shuffled_map.txt"));
+        sim.createAnts(num_ants);
+        sim.run(observer);
+        return observer.trapped;
+    };
+    EXPECT_EQ(countTrapped(OverloadedTrapCounter{}), reference_trapped.size());
+    EXPECT_EQ(countTrapped(TemplatedTrapCounter{}), reference_trapped.size());
+}
+
+// Test 25: Specialized policy instantiations give the same output as the generic path
+TEST_F(AntManiaTest, SpecializedPoliciesMatchGeneric) {
+    MapGeneratorConfig config;
+    config.colonies = 2500;
+    config.missing_edge_ratio = 0.3;
+    ASSERT_TRUE(generateMap(config, "shuffled_map.txt"));
+    config.colonies = 70000;  // Wide connection IDs
+    ASSERT_TRUE(generateMap(config, "large_map.txt"));
+    
+    auto output = [](SimulationEngine engine, RngKind rng, const std::string& map_file, uint32_t num_ants,
+                     bool specialized, bool& used_specialized) {
+        AntManiaSimulation sim;
+        sim.setEngine(engine);
+        sim.setRng(rng);
+        sim.setThreads(2);
+        sim.setSeed(77);
+        sim.setSpecialized(specialized);
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.loadMap(map_file);
+        sim.createAnts(num_ants);
+        sim.runSimulation();
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        used_specialized = sim.usesSpecializedPolicy();
+        
+        std::string text = out.str();
+        text.erase(text.find("Simulation completed in"), text.find(" microseconds") - text.find("Simulation completed in"));
+        return text;
+    };
+    
+    // Enough ants on the small map for the parallel engine to fan out
+    for (auto [map_file, num_ants] : {std::pair<const char*, uint32_t>{"shuffled_map.txt", 40000}, {"large_map.txt", 3000}}) {
+        for (SimulationEngine engine : {SimulationEngine::TWO_PASS, SimulationEngine::FUSED, SimulationEngine::PARALLEL}) {
+            for (RngKind rng : {RngKind::XOSHIRO, RngKind::MT19937, RngKind::COUNTER}) {
+                bool generic_used = true, specialized_used = false;
+                std::string generic = output(engine, rng, map_file, num_ants, false, generic_used);
+                EXPECT_NE(generic.find("has been destroyed"), std::string::npos);
+                EXPECT_EQ(generic, output(engine, rng, map_file, num_ants, true, specialized_used));
+                EXPECT_FALSE(generic_used);
+                
+                // mt19937 has no specialization (except under the parallel engine, which draws COUNTER)
+                bool covered = moveKernelAvailable() && (rng != RngKind::MT19937 || engine == SimulationEngine::PARALLEL);
+                EXPECT_EQ(specialized_used, covered);
+            }
+        }
+    }
+    
+    // Features the specialized policies compile out send the run down the generic path
+    AntManiaSimulation sim;
+    sim.setSilent(true);
+    sim.setSeed(5);
+    ASSERT_TRUE(sim.loadMap("shuffled_map.txt"));
+    sim.setFastForward(false);
+    sim.createAnts(100);
+    sim.runSimulation();
+    EXPECT_FALSE(sim.usesSpecializedPolicy());
+    
+    struct TrappedCounter : NullObserver {
+        uint32_t trapped = 0;
+        void antTrapped(const AntTrappedEvent&) { trapped++; }
+    };
+    sim.setFastForward(true);
+    sim.reset();
+    sim.createAnts(100);
+    TrappedCounter counter;
+    sim.run(counter);
+    EXPECT_FALSE(sim.usesSpecializedPolicy());
+}
+
+// Test 26: The huge-page arena serves reserved space in order, falls back to the heap,
+// and a run drawing its state from it gives the same output as one on the heap
+TEST_F(AntManiaTest, HugePageArenaMatchesHeap) {
+    HugePageArena arena({HugePages::TRANSPARENT, true, true});
+    void* small = arena.allocate(1000);  // Nothing reserved yet: heap
+    EXPECT_FALSE(arena.owns(small));
+    arena.deallocate(small, 1000);
+    
+    arena.reserve(HugePageArena::HUGE_PAGE_SIZE + 1);
+    ASSERT_EQ(arena.stats().blocks, 1u);  // Only fails if mmap itself does
+    EXPECT_EQ(arena.stats().mapped_bytes, 2 * HugePageArena::HUGE_PAGE_SIZE);
+    char* first = static_cast<char*>(arena.allocate(100));
+    char* second = static_cast<char*>(arena.allocate(100));
+    EXPECT_TRUE(arena.owns(first));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % HugePageArena::HUGE_PAGE_SIZE, 0u);
+    EXPECT_EQ(second, first + HugePageArena::roundUp(100));
+    arena.deallocate(second, 100);  // The top allocation is handed back...
+    EXPECT_EQ(arena.allocate(64), second);
+    void* too_big = arena.allocate(4 * HugePageArena::HUGE_PAGE_SIZE);  // ...and what does not fit goes to the heap
+    EXPECT_FALSE(arena.owns(too_big));
+    arena.deallocate(too_big, 4 * HugePageArena::HUGE_PAGE_SIZE);
+    
+    HugePageArena off({HugePages::OFF, false, false});
+    off.reserve(8 * HugePageArena::HUGE_PAGE_SIZE);
+    EXPECT_EQ(off.stats().blocks, 0u);
+    
+    // Large enough that the map tables and the run state each take an arena block
+    MapGeneratorConfig config;
+    config.colonies = 120000;
+    config.shuffle_lines = true;
+    ASSERT_TRUE(generateMap(config, "huge_page_map.txt"));
+    auto output = [](HugePages pages, size_t& arena_bytes) {
+        AntManiaSimulation sim;
+        sim.setEngine(SimulationEngine::FUSED);
+        sim.setSeed(11);
+        sim.setMemoryOptions({pages, pages == HugePages::EXPLICIT, false});
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.loadMap("huge_page_map.txt");
+        sim.createAnts(20000);
+        sim.runSimulation();
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        arena_bytes = sim.getMemory().stats().used_bytes + sim.getGraph()->getMemory().stats().used_bytes;
+        
+        std::string text = out.str();
+        text.erase(text.find("Simulation completed in"), text.find(" microseconds") - text.find("Simulation completed in"));
+        return text;
+    };
+    
+    size_t heap_bytes = 1, transparent_bytes = 0, explicit_bytes = 0;
+    std::string heap = output(HugePages::OFF, heap_bytes);
+    EXPECT_NE(heap.find("has been destroyed"), std::string::npos);
+    EXPECT_EQ(heap, output(HugePages::TRANSPARENT, transparent_bytes));
+    EXPECT_EQ(heap, output(HugePages::EXPLICIT, explicit_bytes));  // Usually falls back to transparent pages
+    EXPECT_EQ(heap_bytes, 0u);
+    EXPECT_GT(transparent_bytes, 120000u * 20);
+    EXPECT_EQ(explicit_bytes, transparent_bytes);
+}
+
+// Test 27: A run driven in slices (step, runFor, interleaved with another run, switching
+// observers) ends exactly like the uninterrupted run
+TEST_F(AntManiaTest, SteppedRunMatchesBlockingRun) {
+    writeGridMap("grid_map.txt");
+    auto console = [](AntManiaSimulation& sim, uint32_t slice) {
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.loadMap("grid_map.txt");
+        sim.createAnts(40);
+        if (slice == 0) {
+            sim.runSimulation();
+        } else {
+            uint32_t steps = 0;
+            for (StepResult progress{}; !progress.finished;) {
+                progress = sim.step(slice);
+                steps += progress.steps;
+                EXPECT_LE(progress.steps, slice);
+                EXPECT_EQ(progress.iterations, sim.getIterations());
+                EXPECT_EQ(progress.ants_alive, sim.getAntsRemaining());
+            }
+            EXPECT_EQ(steps + 1, sim.getIterations());  // The terminating check is counted, as always
+        }
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        
+        std::string text = out.str();
+        text.erase(text.find("Simulation completed in"), text.find(" microseconds") - text.find("Simulation completed in"));
+        return text;
+    };
+    
+    for (SimulationEngine engine : {SimulationEngine::TWO_PASS, SimulationEngine::FUSED, SimulationEngine::PARALLEL}) {
+        std::string blocking;
+        for (uint32_t slice : {0u, 1u, 7u, 1000u}) {
+            AntManiaSimulation sim;
+            sim.setEngine(engine);
+            sim.setThreads(2);
+            sim.setSeed(21);
+            std::string text = console(sim, slice);
+            if (slice == 0) {
+                blocking = text;
+                EXPECT_NE(blocking.find("has been destroyed"), std::string::npos);
+            } else {
+                EXPECT_EQ(text, blocking);
+                EXPECT_EQ(sim.getRunState(), RunState::FINISHED);
+                EXPECT_TRUE(sim.step(10).finished);  // Nothing left to do
+            }
+        }
+    }
+    
+    // Two runs interleaved on one thread, one by deadline and one by steps, switching to an
+    // observer of trapped ants halfway, finish like runs of their own
+    struct TrappedCounter : NullObserver {
+        uint32_t trapped = 0;
+        void antTrapped(const AntTrappedEvent&) { trapped++; }
+    };
+    auto fresh = [](AntManiaSimulation& sim, uint64_t seed) {
+        sim.setSilent(true);
+        sim.setSeed(seed);
+        sim.loadMap("grid_map.txt");
+        sim.createAnts(60);
+    };
+    AntManiaSimulation a, b, a_ref, b_ref;
+    fresh(a, 3); fresh(b, 4); fresh(a_ref, 3); fresh(b_ref, 4);
+    NullObserver none;
+    a_ref.run(none);
+    b_ref.run(none);
+    
+    TrappedCounter counter;
+    uint32_t slices = 0;
+    while (a.getRunState() != RunState::FINISHED || b.getRunState() != RunState::FINISHED) {
+        a.runFor(none, std::chrono::microseconds(20));
+        if (++slices % 2) {
+            b.step(none, 3);
+        } else {
+            b.step(counter, 5);
+        }
+    }
+    EXPECT_GT(slices, 2u);
+    for (auto [sim, ref] : {std::pair<AntManiaSimulation*, AntManiaSimulation*>{&a, &a_ref}, {&b, &b_ref}}) {
+        EXPECT_EQ(sim->getIterations(), ref->getIterations());
+        EXPECT_EQ(sim->getColoniesDestroyed(), ref->getColoniesDestroyed());
+        EXPECT_EQ(sim->getAntsRemaining(), ref->getAntsRemaining());
+        EXPECT_EQ(sim->getAntSteps(), ref->getAntSteps());
+    }
+}
+
+// Test 28: Reordering a map with a hub (hundreds of incoming tunnels, one-way spokes)
+// gives a permutation of the colonies and leaves the output unchanged
+TEST_F(AntManiaTest, ReorderHandlesHubColonies) {
+    {
+        std::ofstream file("hub_map.txt");
+        file << "Hub north=Spoke0 south=Spoke1\n";
+        for (int i = 0; i < 300; ++i) {
+            file << "Spoke" << i << " north=Hub";
+            if (i % 3 == 0) file << " east=Spoke" << (i + 1) % 300;
+            file << "\n";
+        }
+    }
+    
+    ColonyGraph file_order;
+    ASSERT_TRUE(file_order.load("hub_map.txt"));
+    for (ColonyOrder order : {ColonyOrder::BFS, ColonyOrder::RCM}) {
+        ColonyGraph reordered;
+        ASSERT_TRUE(reordered.load("hub_map.txt"));
+        reordered.reorder(order);
+        ASSERT_EQ(reordered.size(), file_order.size());
+        
+        std::vector<uint8_t> seen(reordered.size(), 0);
+        for (uint32_t k = 0; k < file_order.size(); ++k) {
+            uint32_t id = reordered.colonyAtFileIndex(k);
+            ASSERT_LT(id, reordered.size());
+            EXPECT_EQ(seen[id]++, 0);
+            EXPECT_EQ(reordered.fileIndex(id), k);
+            for (int dir = 0; dir < 4; ++dir) {
+                uint32_t actual = reordered.connection(id, dir);
+                EXPECT_EQ(actual == ColonyGraph::NO_CONNECTION ? actual : reordered.fileIndex(actual),
+                          file_order.connection(k, dir));
+            }
+        }
+        EXPECT_EQ(std::string(runSeeded(SimulationEngine::TWO_PASS, RngKind::XOSHIRO, 9, 50, 1, "hub_map.txt", order)),
+                  runSeeded(SimulationEngine::TWO_PASS, RngKind::XOSHIRO, 9, 50, 1, "hub_map.txt"));
+    }
+}
+
+// Test 29: Without a map every entry point ends after the single terminating check
+TEST_F(AntManiaTest, RunWithoutMapTerminates) {
+    AntManiaSimulation blocking;
+    captureOutput();
+    EXPECT_NO_THROW(blocking.runSimulation());
+    restoreOutput();
+    EXPECT_EQ(blocking.getIterations(), 1u);
+    
+    AntManiaSimulation stepped;
+    stepped.setSilent(true);
+    StepResult progress = stepped.step(10);
+    EXPECT_TRUE(progress.finished);
+    EXPECT_EQ(progress.ants_alive, 0u);
+    EXPECT_EQ(stepped.getIterations(), 1u);
+    
+    AntManiaSimulation budgeted;
+    budgeted.setSilent(true);
+    EXPECT_TRUE(budgeted.runFor(std::chrono::milliseconds(10)).finished);
+    EXPECT_EQ(budgeted.getIterations(), 1u);
+}
+
+// Test 30: The live masks and reverse index kept up incrementally as colonies are
+// destroyed match the ones derived from scratch, in every colony order and engine path
+TEST_F(AntManiaTest, LiveMasksMatchRebuildAfterDestructions) {
+    writeGridMap("grid_map.txt", 16);
+    auto checkInvariants = [](const AntManiaSimulation& sim) {
+        const ColonyGraph& graph = *sim.getGraph();
+        std::vector<std::vector<uint32_t>> expected_incoming(graph.size());
+        for (uint32_t c = 0; c < graph.size(); c++) {
+            uint8_t expected_mask = 0;
+            for (uint8_t dir = 0; dir < 4; dir++) {
+                uint32_t target = graph.connection(c, dir);
+                if (target == ColonyGraph::NO_CONNECTION) continue;
+                expected_incoming[target].push_back(c << 2 | dir);
+                if (!sim.isColonyDestroyed(c) && !sim.isColonyDestroyed(target)) expected_mask |= 1 << dir;
+            }
+            EXPECT_EQ(sim.getLiveMask(c), expected_mask) << "colony " << c;
+        }
+        for (uint32_t c = 0; c < graph.size(); c++) {
+            std::vector<uint32_t> incoming(graph.incomingBegin(c), graph.incomingEnd(c));
+            std::sort(incoming.begin(), incoming.end());
+            EXPECT_EQ(incoming, expected_incoming[c]) << "colony " << c;
+        }
+    };
+    
+    for (ColonyOrder order : {ColonyOrder::FILE, ColonyOrder::BFS, ColonyOrder::RCM}) {
+        for (bool specialized : {true, false}) {
+            AntManiaSimulation sim;
+            sim.setSilent(true);
+            sim.setColonyOrder(order);
+            sim.setSpecialized(specialized);
+            sim.setSeed(5);
+            ASSERT_TRUE(sim.loadMap("grid_map.txt"));
+            sim.createAnts(120);
+            checkInvariants(sim);
+            
+            for (StepResult progress{}; !progress.finished;) {
+                progress = sim.step(3);
+                checkInvariants(sim);
+            }
+            EXPECT_GT(sim.getColoniesDestroyed(), 0u);
+            
+            sim.reset();
+            checkInvariants(sim);
+        }
+    }
+}
+
+// Test 31: Engine, thread and RNG changes between slices wait for the next run, so the
+// run in progress ends exactly like an uninterrupted one
+TEST_F(AntManiaTest, SettingsChangedMidRunApplyToNextRun) {
+    MapGeneratorConfig config;
+    config.colonies = 20000;
+    ASSERT_TRUE(generateMap(config, "shuffled_map.txt"));
+    const uint32_t num_ants = 60000;  // Enough for the parallel engine to fan out after the first slice
+    
+    struct Settings { SimulationEngine engine; RngKind rng; uint32_t threads; };
+    auto stepped = [&](Settings start, Settings change, bool specialized) {
+        AntManiaSimulation sim;
+        sim.setEngine(start.engine);
+        sim.setRng(start.rng);
+        sim.setThreads(start.threads);
+        sim.setSpecialized(specialized);
+        sim.setSeed(17);
+        
+        std::ostringstream out;
+        std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+        sim.loadMap("shuffled_map.txt");
+        sim.createAnts(num_ants);
+        StepResult progress = sim.step(1);
+        sim.setEngine(change.engine);
+        sim.setRng(change.rng);
+        sim.setThreads(change.threads);
+        while (!progress.finished) {
+            progress = sim.step(2);
+        }
+        sim.printRemainingWorld();
+        std::cout.rdbuf(previous);
+        EXPECT_EQ(sim.getEngine(), change.engine);  // Kept for the next run
+        
+        std::string text = out.str();
+        size_t timing = text.find("Simulation completed in");
+        if (timing != std::string::npos) {
+            text.erase(timing, text.find('\n', timing) - timing);
+        }
+        return text;
+    };
+    
+    const Settings two_pass{SimulationEngine::TWO_PASS, RngKind::XOSHIRO, 1};
+    const Settings parallel{SimulationEngine::PARALLEL, RngKind::COUNTER, 2};
+    const Settings wider_parallel{SimulationEngine::PARALLEL, RngKind::COUNTER, 8};
+    const Settings fused_mt{SimulationEngine::FUSED, RngKind::MT19937, 1};
+    for (bool specialized : {true, false}) {
+        std::string sequential = runSeeded(two_pass.engine, two_pass.rng, 17, num_ants, 1, "shuffled_map.txt");
+        EXPECT_NE(sequential.find("has been destroyed"), std::string::npos);
+        EXPECT_EQ(stepped(two_pass, wider_parallel, specialized), sequential);
+        EXPECT_EQ(stepped(two_pass, fused_mt, specialized), sequential);
+        
+        std::string threaded = runSeeded(parallel.engine, parallel.rng, 17, num_ants, parallel.threads, "shuffled_map.txt");
+        EXPECT_EQ(stepped(parallel, wider_parallel, specialized), threaded);
+        EXPECT_EQ(stepped(parallel, fused_mt, specialized), threaded);
+    }
+}